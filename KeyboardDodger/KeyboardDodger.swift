@@ -27,6 +27,40 @@ import UIKit
     case updateAfterKeyboardChange
 }
 
+// MARK: - Keyboard dodger strategy
+
+/// How the keyboard dodger moves its content out of the way of the keyboard.
+@objc public enum KeyboardDodgerStrategy: Int {
+    
+    /// The keyboard dodger changes its constraint's constant, and animates a layout pass. This is the default.
+    case constraint
+    
+    /// The keyboard dodger animates a translation transform on its `transformView`, and leaves its constraint alone.
+    /// This keeps the animation on the render server and off the layout engine, which is all that's needed when the only thing
+    /// moving is something like a bottom toolbar.
+    case transform
+    
+    /// The keyboard dodger changes its constraint's constant without animation once the keyboard has finished moving.
+    /// The content jumps into place rather than moving with the keyboard, but nothing is laid out while the keyboard is animating.
+    case deferred
+}
+
+// MARK: - Keyboard dodger layout scope
+
+/// Which view the keyboard dodger lays out as it animates its constraint.
+@objc public enum KeyboardDodgerLayoutScope: Int {
+    
+    /// The keyboard dodger lays out its view. This is the default.
+    case view
+    
+    /// The keyboard dodger lays out the nearest common ancestor of its constraint's first and second items.
+    /// This is the smallest subtree the constraint can move, so it avoids re-solving the rest of the screen when the view is a controller's root view.
+    case constraintItems
+    
+    /// The keyboard dodger lays out its `customLayoutView`, falling back to its view when that isn't set.
+    case custom
+}
+
 // MARK: - Keyboard dodger delegate
 
 /// Optional messages that can be received as the keyboard is shown/hidden.
@@ -55,26 +89,31 @@ import UIKit
     /// calculation until after everything has finished moving around. Checking size classes instead of the device idiom means that split screen is handled correctly.
     @objc optional func keyboardDodger(_ keyboardDodger: KeyboardDodger, behaviorFor transition: KeyboardDodgerTransition) -> KeyboardDodgerBehavior
     
+    /// Called when a layout pass has gone over the keyboard dodger's `layoutBudget`, and it has switched to a cheaper strategy for its following moves.
+    @objc optional func keyboardDodger(_ keyboardDodger: KeyboardDodger, didDegradeTo strategy: KeyboardDodgerStrategy, afterLayoutTaking duration: TimeInterval)
+    
 }
 
-// MARK: - Keyboard dodger transition
+// MARK: - Keyboard dodger payload
 
-/// A convenience object used for parsing the keyboard notifications.
-@objc public final class KeyboardDodgerTransition: NSObject {
+/// The values carried by a keyboard notification's userInfo dictionary, as a value type.
+///
+/// Parsing a payload doesn't allocate, so Swift code that only needs the keyboard frames can use this instead of a KeyboardDodgerTransition.
+public struct KeyboardDodgerPayload: Equatable {
     
     /// Equivalent to UIKeyboardFrameBeginUserInfoKey.
-    @objc public let startFrame: CGRect
+    public var startFrame: CGRect
     
     /// Equivalent to UIKeyboardFrameEndUserInfoKey.
-    @objc public let endFrame: CGRect
+    public var endFrame: CGRect
     
     /// Equivalent to UIKeyboardAnimationDurationUserInfoKey.
-    @objc public let animationDuration: TimeInterval
+    public var animationDuration: TimeInterval
     
     /// Equivalent to UIKeyboardAnimationCurveUserInfoKey.
-    @objc public let animationCurve: UIView.AnimationCurve
+    public var animationCurve: UIView.AnimationCurve
     
-    @objc public init(startFrame: CGRect, endFrame: CGRect, animationDuration: TimeInterval, animationCurve: UIView.AnimationCurve) {
+    public init(startFrame: CGRect, endFrame: CGRect, animationDuration: TimeInterval, animationCurve: UIView.AnimationCurve) {
         self.startFrame = startFrame
         self.endFrame = endFrame
         self.animationDuration = animationDuration
@@ -82,48 +121,111 @@ import UIKit
     }
     
     /// Initialise with the userInfo dictionary from UIKeyboardWillChangeFrameNotification or UIKeyboardWillHideNotification.
-    @objc public convenience init?(dictionary: [AnyHashable: Any]) {
-        guard let startFrame = dictionary[UIResponder.keyboardFrameBeginUserInfoKey] as? CGRect else {
+    ///
+    /// The values are cast to the Objective-C types UIKit actually stores, which is much cheaper than bridging casts to CGRect and Int.
+    public init?(dictionary: [AnyHashable: Any]) {
+        guard let startFrame = dictionary[UIResponder.keyboardFrameBeginUserInfoKey] as? NSValue else {
+            return nil
+        }
+        
+        guard let endFrame = dictionary[UIResponder.keyboardFrameEndUserInfoKey] as? NSValue else {
             return nil
         }
         
-        guard let endFrame = dictionary[UIResponder.keyboardFrameEndUserInfoKey] as? CGRect else {
+        guard let animationDuration = dictionary[UIResponder.keyboardAnimationDurationUserInfoKey] as? NSNumber else {
             return nil
         }
         
-        guard let animationDuration = dictionary[UIResponder.keyboardAnimationDurationUserInfoKey] as? TimeInterval else {
+        guard let animationCurve = (dictionary[UIResponder.keyboardAnimationCurveUserInfoKey] as? NSNumber).flatMap({ UIView.AnimationCurve(rawValue: $0.intValue) }) else {
             return nil
         }
         
-        guard let animationCurve = (dictionary[UIResponder.keyboardAnimationCurveUserInfoKey] as? Int).flatMap(UIView.AnimationCurve.init(rawValue:)) else {
+        self.init(startFrame: startFrame.cgRectValue, endFrame: endFrame.cgRectValue, animationDuration: animationDuration.doubleValue, animationCurve: animationCurve)
+    }
+    
+    /// The payload as a userInfo dictionary, in the same form UIKit sends with its keyboard notifications.
+    ///
+    /// This is useful for synthesizing keyboard notifications, e.g. to drive dodgers from a benchmark without a real keyboard.
+    public var dictionary: [AnyHashable: Any] {
+        return [
+            UIResponder.keyboardFrameBeginUserInfoKey: NSValue(cgRect: startFrame),
+            UIResponder.keyboardFrameEndUserInfoKey: NSValue(cgRect: endFrame),
+            UIResponder.keyboardAnimationDurationUserInfoKey: NSNumber(value: animationDuration),
+            UIResponder.keyboardAnimationCurveUserInfoKey: NSNumber(value: animationCurve.rawValue)
+        ]
+    }
+    
+}
+
+// MARK: - Keyboard dodger transition
+
+/// A convenience object used for parsing the keyboard notifications.
+@objc public final class KeyboardDodgerTransition: NSObject {
+    
+    /// Equivalent to UIKeyboardFrameBeginUserInfoKey.
+    @objc public let startFrame: CGRect
+    
+    /// Equivalent to UIKeyboardFrameEndUserInfoKey.
+    @objc public let endFrame: CGRect
+    
+    /// Equivalent to UIKeyboardAnimationDurationUserInfoKey.
+    @objc public let animationDuration: TimeInterval
+    
+    /// Equivalent to UIKeyboardAnimationCurveUserInfoKey.
+    @objc public let animationCurve: UIView.AnimationCurve
+    
+    @objc public init(startFrame: CGRect, endFrame: CGRect, animationDuration: TimeInterval, animationCurve: UIView.AnimationCurve) {
+        self.startFrame = startFrame
+        self.endFrame = endFrame
+        self.animationDuration = animationDuration
+        self.animationCurve = animationCurve
+    }
+    
+    /// Initialise with a payload that has already been parsed from a keyboard notification.
+    public convenience init(payload: KeyboardDodgerPayload) {
+        self.init(startFrame: payload.startFrame, endFrame: payload.endFrame, animationDuration: payload.animationDuration, animationCurve: payload.animationCurve)
+    }
+    
+    /// Initialise with the userInfo dictionary from UIKeyboardWillChangeFrameNotification or UIKeyboardWillHideNotification.
+    @objc public convenience init?(dictionary: [AnyHashable: Any]) {
+        guard let payload = KeyboardDodgerPayload(dictionary: dictionary) else {
             return nil
         }
         
-        self.init(startFrame: startFrame, endFrame: endFrame, animationDuration: animationDuration, animationCurve: animationCurve)
+        self.init(payload: payload)
+    }
+    
+    /// Timing parameters that move in step with the keyboard.
+    ///
+    /// The keyboard usually animates with a private curve (raw value 7) which has no named case. The raw curve is passed through to UIKit unchanged,
+    /// so it animates with the system's own keyboard timing rather than an approximation of it.
+    @objc public var timingParameters: UICubicTimingParameters {
+        return UICubicTimingParameters(animationCurve: animationCurve)
+    }
+    
+    /// The transition's values as a payload.
+    public var payload: KeyboardDodgerPayload {
+        return KeyboardDodgerPayload(startFrame: startFrame, endFrame: endFrame, animationDuration: animationDuration, animationCurve: animationCurve)
     }
     
     /// Calculates the height of the overlap between a view and the keyboard at the start of the transition.
     ///
     /// We take the overlap rather than just the height of the keyboard, as the view doesn't always take up the full screen
     /// (e.g. a form sheet on an iPad)
+    ///
+    /// The view's position is measured the first time it is passed to any of these methods, and reused for the rest of the transition.
     @objc public func initialConstraintHeight(for view: UIView) -> CGFloat {
-        guard let frame = view.superview?.convert(view.frame, to: nil), keyboardIsDockedAtStart else {
-            return 0.0
-        }
-        
-        return frame.intersection(startFrame).height
+        return geometry(for: view).initialOverlap
     }
     
     /// Calculates the height of the overlap between a view and the keyboard at the end of the transition.
     ///
     /// We take the overlap rather than just the height of the keyboard, as the view doesn't always take up the full screen
     /// (e.g. a form sheet on an iPad)
+    ///
+    /// The view's position is measured the first time it is passed to any of these methods, and reused for the rest of the transition.
     @objc public func finalConstraintHeight(for view: UIView) -> CGFloat {
-        guard let frame = view.superview?.convert(view.frame, to: nil), keyboardIsDockedAtEnd else {
-            return 0.0
-        }
-        
-        return frame.intersection(endFrame).height
+        return geometry(for: view).finalOverlap
     }
     
     /// Calculates the height of the overlap between a view and the keyboard at the start and end of the transition, and returns whether the overlap is expanding or not.
@@ -131,7 +233,7 @@ import UIKit
     /// This is potentially useful to know if we want to anticipate how the constraint handler might interact with a view controller which is moving
     /// (e.g. when a form sheet on an iPad moves underneath the keyboard)
     @objc public func isExpanding(in view: UIView) -> Bool {
-        return initialConstraintHeight(for: view) < finalConstraintHeight(for: view)
+        return geometry(for: view).isExpanding
     }
     
     /// Calculates the height of the overlap between a view and the keyboard at the start and end of the transition, and returns whether the overlap is collapsing or not.
@@ -139,17 +241,74 @@ import UIKit
     /// This is potentially useful to know if we want to anticipate how the constraint handler might interact with a view controller which is moving
     /// (e.g. when a form sheet on an iPad moves underneath the keyboard)
     @objc public func isCollapsing(in view: UIView) -> Bool {
-        return initialConstraintHeight(for: view) > finalConstraintHeight(for: view)
+        return geometry(for: view).isCollapsing
+    }
+    
+    /// The geometry of a view against this transition, which all of the methods above are calculated from.
+    ///
+    /// Converting the view's frame into screen space walks the whole superview chain, so this is done once per view, and cached for the rest of the transition.
+    /// The view is measured against the screen its own window is on, which keeps the geometry correct for apps with several windows or screens.
+    public func geometry(for view: UIView) -> KeyboardDodgerGeometry {
+        let key = ObjectIdentifier(view)
+        
+        if let measurement = measurements[key], measurement.view === view {
+            return measurement.geometry
+        }
+        
+        let geometry = KeyboardDodgerInstrumentation.shared.interval("Geometry") { () -> KeyboardDodgerGeometry in
+            // A view that isn't in a window can't be overlapped by the keyboard
+            guard let screen = view.window?.screen else {
+                return KeyboardDodgerGeometry(viewFrame: .null, screenBounds: .null, startFrame: startFrame, endFrame: endFrame)
+            }
+            
+            let viewFrame = view.convert(view.bounds, to: screen.coordinateSpace)
+            return KeyboardDodgerGeometry(viewFrame: viewFrame, screenBounds: bounds(of: screen), startFrame: startFrame, endFrame: endFrame)
+        }
+        
+        measurements[key] = Measurement(view: view, geometry: geometry)
+        return geometry
+    }
+    
+    /// The view's geometry against this transition, given a frame in the screen's coordinate space measured earlier, such as by a dodger's cache.
+    internal func geometry(for view: UIView, frame viewFrame: CGRect, in screen: UIScreen) -> KeyboardDodgerGeometry {
+        let key = ObjectIdentifier(view)
+        
+        if let measurement = measurements[key], measurement.view === view {
+            return measurement.geometry
+        }
+        
+        let geometry = KeyboardDodgerGeometry(viewFrame: viewFrame, screenBounds: bounds(of: screen), startFrame: startFrame, endFrame: endFrame)
+        
+        measurements[key] = Measurement(view: view, geometry: geometry)
+        return geometry
     }
     
     // MARK: Private helpers
     
-    private var keyboardIsDockedAtStart: Bool {
-        return UIScreen.main.bounds.maxY == startFrame.maxY
+    /// A view's geometry against this transition.
+    private struct Measurement {
+        
+        /// The measured view, kept weakly so a new view allocated at the same address isn't mistaken for it.
+        weak var view: UIView?
+        
+        var geometry: KeyboardDodgerGeometry
+        
     }
     
-    private var keyboardIsDockedAtEnd: Bool {
-        return UIScreen.main.bounds.maxY == endFrame.maxY
+    /// The geometry measured so far, keyed by view. A transition is usually only shared between a handful of dodgers, so this stays small.
+    private var measurements: [ObjectIdentifier: Measurement] = [:]
+    
+    /// The bounds of each screen measured against so far, keyed by screen, so views in the same scene share a single lookup.
+    private var screenBounds: [ObjectIdentifier: CGRect] = [:]
+    
+    private func bounds(of screen: UIScreen) -> CGRect {
+        if let bounds = screenBounds[ObjectIdentifier(screen)] {
+            return bounds
+        }
+        
+        let bounds = screen.bounds
+        screenBounds[ObjectIdentifier(screen)] = bounds
+        return bounds
     }
     
 }
@@ -157,125 +316,1011 @@ import UIKit
 // MARK: - Keyboard dodger
 
 /// Handles animating a bottom constraint for a view as the keyboard is shown/hidden/adjusted.
+///
+/// The dodger adds a hidden, empty subview to its view (to a visual effect view's `contentView`), which tells it when the view's traits or size change.
+/// If that subview is removed, such as by code that rebuilds the view's subviews, the dodger puts it back the next time it needs it.
 @objc public final class KeyboardDodger: NSObject {
     
     /// The view that contains the bottom constraint you want to manipulate when the keyboard is shown/hidden.
-    @objc public let view: UIView
+    /// This is held weakly, so a dodger kept around by a long animation doesn't keep its view controller's views alive. Once the view has been
+    /// deallocated, the dodger stops listening for keyboard notifications.
+    @objc public private(set) weak var view: UIView!
     
-    /// The bottom constraint in the view that should adjust as the keyboard is shown/hidden.
-    @objc public let constraint: NSLayoutConstraint
+    /// The bottom constraint in the view that should adjust as the keyboard is shown/hidden, held weakly like the view.
+    /// This is `nil` for a dodger that only moves its targets or appliers, such as one made with `init(scrollView:delegate:)`.
+    @objc public private(set) weak var constraint: NSLayoutConstraint?
     
     /// The initial value for the bottom constraint in the view. Used to reset the constraint's constant back to its initial value.
     @objc private let constant: CGFloat
     
     /// The delegate is sent messages when the constraint values change.
-    @objc public weak var delegate: KeyboardDodgerDelegate?
+    @objc public weak var delegate: KeyboardDodgerDelegate? {
+        didSet {
+            delegateMethods = DelegateMethods(delegate: delegate)
+        }
+    }
+    
+    /// Called when the dodger is about to update its constraint, without any Objective-C dispatch. Called after the equivalent delegate method.
+    public var onWillUpdate: ((KeyboardDodgerTransition) -> Void)?
+    
+    /// Called when the dodger has finished updating its constraint, without any Objective-C dispatch. Called after the equivalent delegate method.
+    public var onDidUpdate: ((KeyboardDodgerTransition) -> Void)?
+    
+    /// Called when the dodger is about to reset its constraint, without any Objective-C dispatch. Called after the equivalent delegate method.
+    public var onWillReset: ((KeyboardDodgerTransition) -> Void)?
+    
+    /// Called when the dodger has finished resetting its constraint, without any Objective-C dispatch. Called after the equivalent delegate method.
+    public var onDidReset: ((KeyboardDodgerTransition) -> Void)?
+    
+    /// Decides the dodger's behavior for a transition, without any Objective-C dispatch. Takes precedence over the delegate's `keyboardDodger(_:behaviorFor:)`.
+    public var behaviorProvider: ((KeyboardDodgerTransition) -> KeyboardDodgerBehavior?)?
+    
+    /// Called when the dodger has switched to a cheaper strategy after going over its layout budget, without any Objective-C dispatch.
+    /// Called after the equivalent delegate method.
+    public var onDegrade: ((KeyboardDodgerStrategy, TimeInterval) -> Void)?
+    
+    /// Anything else to move out of the way of the keyboard along with the constraint, such as other constraints or transforms.
+    /// The targets move within the same animation as the constraint, and share a single layout pass with it.
+    @objc public var targets: [KeyboardDodgerTarget] = []
+    
+    /// The Swift-only appliers added with `add(_:)`, each wrapped in closures so appliers of different types can share the array.
+    private var appliers: [AnyApplier] = []
+    
+    /// The applier of the `KeyboardDodgerOf` driving this dodger, if any, wrapped up where its type is known.
+    @usableFromInline internal var specializedApplier: AnyApplier?
+    
+    /// How the dodger moves its content out of the way of the keyboard. Defaults to `.constraint`.
+    @objc public var strategy: KeyboardDodgerStrategy = .constraint
+    
+    /// The view translated when `strategy` is `.transform`. Its transform is replaced while the keyboard is shown.
+    /// When this isn't set, the dodger falls back to changing its constraint.
+    @objc public weak var transformView: UIView?
+    
+    /// Whether the transform strategy should swap its transform for the equivalent constraint constant once each animation has finished,
+    /// with a single non-animated layout pass. Defaults to `false`.
+    @objc public var commitsTransformToConstraint: Bool = false
+    
+    /// Which view the dodger lays out as it animates its constraint. Defaults to `.view`.
+    @objc public var layoutScope: KeyboardDodgerLayoutScope = .view
+    
+    /// The view to lay out when `layoutScope` is `.custom`.
+    @objc public weak var customLayoutView: UIView?
+    
+    /// The view the dodger will lay out, as picked by its `layoutScope`, or `nil` once the views have been deallocated.
+    @objc public var layoutView: UIView? {
+        switch layoutScope {
+        case .view:
+            return view
+        case .constraintItems:
+            return constraint?.nearestCommonAncestor ?? view
+        case .custom:
+            return customLayoutView ?? view
+        }
+    }
+    
+    /// A scroll view whose interactive keyboard dismissal the dodger should follow (i.e. one with a `keyboardDismissMode` of `.interactive`).
+    ///
+    /// While the keyboard is being dragged down, the dodger keeps up with it by translating its `transformView` from the scroll view's pan gesture.
+    /// The constraint itself is only committed by the keyboard notification sent once the gesture ends.
+    ///
+    /// Set a `transformView` too. Without one, the dodger falls back to setting its constraint and running a layout pass on every frame of the
+    /// gesture, which is as expensive as following the keyboard by hand.
+    @objc public weak var interactiveDismissalScrollView: UIScrollView? {
+        didSet {
+            oldValue?.panGestureRecognizer.removeTarget(self, action: #selector(interactiveDismissalPanDidChange(_:)))
+            interactiveDismissalScrollView?.panGestureRecognizer.addTarget(self, action: #selector(interactiveDismissalPanDidChange(_:)))
+        }
+    }
+    
+    /// Whether keyboard changes arriving in quick succession should be coalesced, so only the latest is applied, once per display frame.
+    ///
+    /// Switching between keyboards (e.g. emoji and QuickType, or toggling the predictive bar) sends several frame changes in a row,
+    /// each of which would otherwise animate its own layout pass, only to be superseded straight away. Defaults to `false`.
+    @objc public var coalescesKeyboardChanges: Bool = false
+    
+    /// The smallest change to the constraint's constant, in points, that the dodger will animate. Smaller changes, such as the
+    /// fractions of a point the QuickType bar can jitter by on rotation, are ignored. Going back to the initial constant is never ignored.
+    ///
+    /// Overlaps are always rounded to the view's display scale first, so changes that wouldn't move a pixel are ignored regardless. Defaults to `0.0`.
+    @objc public var changeThreshold: CGFloat = 0.0
+    
+    /// The longest a single layout pass may take, in seconds, before the dodger switches to a cheaper strategy, or `0.0` for no budget.
+    ///
+    /// A dodger over budget moves from `.constraint` to `.transform` if it has a `transformView`, and otherwise to `.deferred`, and tells its delegate.
+    /// The dodger switches, and tells its delegate, just after the animation that went over budget has been set up, so nothing the delegate does
+    /// is caught up in it. The new strategy applies from the next move. Defaults to `0.0`.
+    @objc public var layoutBudget: TimeInterval = 0.0
+    
+    /// Whether the dodger should remember its view's frame on screen between keyboard notifications, instead of converting it through
+    /// the superview chain each time. Defaults to `false`.
+    ///
+    /// The frame is measured again whenever the view is resized, moves to another window or changes traits, after a size transition,
+    /// before an update that waits for the keyboard to finish moving, and once the keyboard has hidden. If the view can be moved on screen
+    /// any other way while the keyboard is up, such as by one of its ancestors, call `invalidateViewFrame()` when it moves.
+    @objc public var cachesViewFrame: Bool = false {
+        didSet {
+            cachedViewFrame = nil
+        }
+    }
+    
+    /// Whether the dodger should only listen for keyboard notifications while a text field or text view inside its view is being edited,
+    /// or while it still has the keyboard to get out of the way of. The rest of the time it costs nothing per keyboard notification.
+    ///
+    /// Only text fields and text views wake the dodger, so leave this off if the keyboard is brought up by another kind of responder. Defaults to `false`.
+    @objc public var listensOnlyWhileEditing: Bool = false {
+        didSet {
+            KeyboardDodgerHub.shared.updateRegistration(of: self)
+        }
+    }
     
     /// Instantiates a KeyboardDodger. Keep a reference to this around while you want it to handle
     /// manipulating the bottom constraint of the view.
-    @objc public init(view: UIView, constraint: NSLayoutConstraint, delegate: KeyboardDodgerDelegate? = nil) {
+    @objc public convenience init(view: UIView, constraint: NSLayoutConstraint, delegate: KeyboardDodgerDelegate? = nil) {
+        self.init(view: view, constraint: constraint, targets: [], delegate: delegate)
+    }
+    
+    /// Instantiates a KeyboardDodger that has no constraint of its own, and only moves its targets out of the way of the keyboard overlapping the view.
+    @objc public convenience init(view: UIView, targets: [KeyboardDodgerTarget], delegate: KeyboardDodgerDelegate? = nil) {
+        self.init(view: view, constraint: nil, targets: targets, delegate: delegate)
+    }
+    
+    /// Instantiates a KeyboardDodger that keeps a scroll view's content clear of the keyboard by adjusting its bottom insets instead of a constraint.
+    /// The scroll view keeps its bounds, so table and collection views don't need to re-layout their cells.
+    @objc public convenience init(scrollView: UIScrollView, delegate: KeyboardDodgerDelegate? = nil) {
+        self.init(view: scrollView, constraint: nil, targets: [KeyboardDodgerScrollViewTarget(scrollView: scrollView)], delegate: delegate)
+    }
+    
+    /// Instantiates a KeyboardDodger that has no constraint of its own, and only moves the applier out of the way of the keyboard overlapping the view.
+    public convenience init<Applier: KeyboardDodgerApplier>(view: UIView, applier: Applier, delegate: KeyboardDodgerDelegate? = nil) {
+        self.init(view: view, constraint: nil, targets: [], delegate: delegate)
+        
+        add(applier)
+    }
+    
+    private init(view: UIView, constraint: NSLayoutConstraint?, targets: [KeyboardDodgerTarget], delegate: KeyboardDodgerDelegate?) {
         self.view = view
         self.constraint = constraint
-        self.constant = constraint.constant
+        self.constant = constraint?.constant ?? 0.0
+        self.appliedConstant = constraint?.constant ?? 0.0
+        self.targets = targets
         self.delegate = delegate
+        self.delegateMethods = DelegateMethods(delegate: delegate)
         
         super.init()
         
-        NotificationCenter.default.addObserver(self, selector: #selector(keyboardWillChangeFrame(_:)), name: UIResponder.keyboardWillChangeFrameNotification, object: nil)
-        NotificationCenter.default.addObserver(self, selector: #selector(keyboardDidChangeFrame(_:)), name: UIResponder.keyboardDidChangeFrameNotification, object: nil)
-        NotificationCenter.default.addObserver(self, selector: #selector(keyboardWillHide(_:)), name: UIResponder.keyboardWillHideNotification, object: nil)
-        NotificationCenter.default.addObserver(self, selector: #selector(keyboardDidHide(_:)), name: UIResponder.keyboardDidHideNotification, object: nil)
+        installObserverViewIfNeeded()
+        
+        KeyboardDodgerHub.shared.register(self)
     }
     
     deinit {
-        NotificationCenter.default.removeObserver(self)
+        // Gesture recognizers don't retain their targets
+        interactiveDismissalScrollView?.panGestureRecognizer.removeTarget(self, action: nil)
+        
+        observerView.removeFromSuperview()
+    }
+    
+    // MARK: Appliers
+    
+    /// Adds an applier to move out of the way of the keyboard along with the constraint and targets, within the same animation and layout pass.
+    ///
+    /// The applier's `apply(overlap:)` is called as a Swift function, with no Objective-C message send the way a target's is.
+    public func add<Applier: KeyboardDodgerApplier>(_ applier: Applier) {
+        appliers.append(AnyApplier(applier))
+    }
+    
+    /// Removes every applier added with `add(_:)`, leaving them wherever they are.
+    public func removeAllAppliers() {
+        appliers.removeAll()
     }
     
     // MARK: Notifications
     
-    @objc private func keyboardWillChangeFrame(_ notification: Notification) {
-        guard let userInfo = notification.userInfo, let transition = KeyboardDodgerTransition(dictionary: userInfo) else {
-            return
+    /// Called by the hub before it parses a keyboard notification, to find out whether the dodger needs it at all.
+    ///
+    /// A dodger whose view is hidden or not in a window (e.g. in another tab, or a popped view controller that's been kept around) sits out,
+    /// so background view controllers cost nothing during keyboard animations. The exception is a hide, when the dodger has moved its constraint and
+    /// needs to put it back before the view becomes visible again.
+    internal func isListening(for event: KeyboardDodgerEvent) -> Bool {
+        guard let view = view else {
+            return false
         }
         
-        if behavior(for: transition) == .updateWithKeyboardChange {
-            updateConstraint(with: transition)
+        if view.window != nil && view.isHidden == false {
+            return true
         }
+        
+        switch event {
+        case .willHide, .didHide:
+            return appliedConstant != constant || pendingAction != nil
+        case .willChangeFrame, .didChangeFrame:
+            return false
+        }
+    }
+    
+    /// Called by the hub before it parses a did event, to find out whether the will event before it has already done all the work.
+    /// If the will event decided to update along with the keyboard, the did event has nothing left to do, and the decision is used up.
+    internal func consumeDecision(for event: KeyboardDodgerEvent) -> Bool {
+        guard decidedBehaviors[event] == .updateWithKeyboardChange else {
+            return false
+        }
+        
+        decidedBehaviors[event] = nil
+        return true
+    }
+    
+    /// Called by the hub when a keyboard event doesn't reach the dodger, so a decision made for an earlier notification isn't applied to a later one.
+    /// A will event that doesn't arrive can't decide for its did event, and a did event that doesn't arrive has no use for its decision.
+    internal func discardDecision(for event: KeyboardDodgerEvent) {
+        decidedBehaviors[event.completion ?? event] = nil
     }
     
-    @objc private func keyboardDidChangeFrame(_ notification: Notification) {
-        guard let userInfo = notification.userInfo, let transition = KeyboardDodgerTransition(dictionary: userInfo) else {
+    /// The text field or text view inside the view that woke the dodger, while `listensOnlyWhileEditing` is on.
+    internal weak var editingView: UIView?
+    
+    /// Whether the hub can stop sending the dodger keyboard notifications until editing begins inside its view again.
+    internal var isDormant: Bool {
+        return listensOnlyWhileEditing && editingView?.isFirstResponder != true && appliedConstant == constant && pendingAction == nil
+    }
+    
+    /// Called by the hub for every keyboard notification the dodger is listening for.
+    internal func handle(_ event: KeyboardDodgerEvent, with transition: KeyboardDodgerTransition) {
+        let instrumentation = KeyboardDodgerInstrumentation.shared
+        instrumentation.increment(.event)
+        
+        let behavior: KeyboardDodgerBehavior
+        
+        if let completion = event.completion {
+            behavior = instrumentation.interval("Behavior") { self.behavior(for: transition) }
+            decidedBehaviors[completion] = behavior
+        } else {
+            // The will event decides for its did event, so the geometry and delegate queries don't need repeating here
+            behavior = decidedBehaviors.removeValue(forKey: event) ?? instrumentation.interval("Behavior") { self.behavior(for: transition) }
+            
+            // Anything that moved the view along with the keyboard, such as a form sheet, has settled by now
+            if behavior == .updateAfterKeyboardChange || event == .didHide {
+                cachedViewFrame = nil
+            }
+        }
+        
+        let action: Action
+        
+        switch (event, behavior) {
+        case (.willChangeFrame, .updateWithKeyboardChange), (.didChangeFrame, .updateAfterKeyboardChange):
+            action = .update
+        case (.willHide, .updateWithKeyboardChange), (.didHide, .updateAfterKeyboardChange):
+            action = .reset
+        default:
             return
         }
         
-        if behavior(for: transition) == .updateAfterKeyboardChange {
-            updateConstraint(with: transition)
+        if coalescesKeyboardChanges {
+            pendingAction = (action: action, transition: transition)
+            KeyboardDodgerHub.shared.setNeedsFlush(self)
+        } else {
+            perform(action, with: transition)
         }
     }
     
-    @objc private func keyboardWillHide(_ notification: Notification) {
-        guard let userInfo = notification.userInfo, let transition = KeyboardDodgerTransition(dictionary: userInfo) else {
+    /// The behaviors decided by will events, keyed by the did events that follow them.
+    private var decidedBehaviors: [KeyboardDodgerEvent: KeyboardDodgerBehavior] = [:]
+    
+    /// Called by the hub on the display frame after a keyboard change was coalesced.
+    internal func flushPendingAction() {
+        guard let pendingAction = pendingAction, view != nil else {
             return
         }
         
-        if behavior(for: transition) == .updateWithKeyboardChange {
+        self.pendingAction = nil
+        perform(pendingAction.action, with: pendingAction.transition)
+    }
+    
+    /// Called by the observer view when the view's traits or window change.
+    internal func viewTraitsDidChange() {
+        cachedIsFullScreen = nil
+        cachedViewFrame = nil
+    }
+    
+    /// Called by the observer view when it's laid out, which it is whenever the view is resized.
+    ///
+    /// A split view resize can change the window's size class while the view's stays the same, which the view doesn't hear about as a trait change.
+    internal func viewLayoutDidChange() {
+        cachedIsFullScreen = nil
+        cachedViewFrame = nil
+    }
+    
+    // MARK: View frame
+    
+    /// Tells the dodger its view has moved on screen, when `cachesViewFrame` is on and the view has been moved in a way the dodger can't see.
+    @objc public func invalidateViewFrame() {
+        cachedViewFrame = nil
+    }
+    
+    /// The view's frame in its screen's coordinate space, as of the last keyboard notification, while `cachesViewFrame` is on.
+    private var cachedViewFrame: (frame: CGRect, screen: UIScreen)?
+    
+    /// The view's geometry against the transition, using the cached frame if there is one.
+    private func geometry(for transition: KeyboardDodgerTransition) -> KeyboardDodgerGeometry {
+        // Like a view out of its window, a view that has gone can't be overlapped by the keyboard
+        guard let view = view else {
+            return KeyboardDodgerGeometry(viewFrame: .null, screenBounds: .null, startFrame: transition.startFrame, endFrame: transition.endFrame)
+        }
+        
+        guard cachesViewFrame else {
+            return transition.geometry(for: view)
+        }
+        
+        installObserverViewIfNeeded()
+        
+        if let cachedViewFrame = cachedViewFrame {
+            return transition.geometry(for: view, frame: cachedViewFrame.frame, in: cachedViewFrame.screen)
+        }
+        
+        let geometry = transition.geometry(for: view)
+        
+        if let screen = view.window?.screen {
+            cachedViewFrame = (frame: geometry.viewFrame, screen: screen)
+        }
+        
+        return geometry
+    }
+    
+    // MARK: Actions
+    
+    /// What the dodger does in response to a keyboard notification.
+    private enum Action {
+        
+        /// Moves the constraint out of the way of the keyboard.
+        case update
+        
+        /// Moves the constraint back to its initial value.
+        case reset
+        
+    }
+    
+    /// The latest action waiting for the next display frame, when coalescing.
+    private var pendingAction: (action: Action, transition: KeyboardDodgerTransition)?
+    
+    private func perform(_ action: Action, with transition: KeyboardDodgerTransition) {
+        switch action {
+        case .update:
+            keyboardFrame = transition.endFrame
+            recordKeyboardFrame(for: transition)
+            updateConstraint(with: transition)
+        case .reset:
+            keyboardFrame = nil
             resetConstraint(with: transition)
         }
     }
     
-    @objc private func keyboardDidHide(_ notification: Notification) {
-        guard let userInfo = notification.userInfo, let transition = KeyboardDodgerTransition(dictionary: userInfo) else {
+    // MARK: Prediction
+    
+    /// Moves the constraint to where the keyboard is expected to end up, before the keyboard is shown.
+    ///
+    /// Call this once the view is in its window, just before a text input becomes first responder, so the first keyboard appearance only needs to
+    /// animate a small correction rather than a full layout. The prediction is the last docked keyboard seen with the same screen size,
+    /// size class and (if a responder is given) input mode, by any dodger in the process. The delegate is told about the update as usual.
+    ///
+    /// Returns `false`, and does nothing, if the view isn't in a window or no keyboard has been seen in these conditions yet.
+    @discardableResult @objc public func prepareForKeyboard(with responder: UIResponder?) -> Bool {
+        preparedResponder = responder
+        
+        guard let window = view?.window, let frame = KeyboardDodgerHub.shared.predictedKeyboardFrame(screen: window.screen, sizeClass: window.traitCollection.horizontalSizeClass, inputMode: responder?.textInputMode?.primaryLanguage) else {
+            return false
+        }
+        
+        updateConstraint(with: KeyboardDodgerTransition(startFrame: frame, endFrame: frame, animationDuration: 0.0, animationCurve: .linear))
+        return true
+    }
+    
+    /// The responder passed to the last `prepareForKeyboard(with:)`, whose input mode the keyboard that actually appears is recorded under.
+    private weak var preparedResponder: UIResponder?
+    
+    /// The primary language of the keyboard being shown right now, if the dodger knows which responder it's being shown for.
+    ///
+    /// This is read when the frame is recorded rather than when the keyboard was prepared for, as the user may have switched keyboards since.
+    /// A responder that's no longer first responder isn't showing the keyboard, so its input mode can't be trusted.
+    private var currentInputMode: String? {
+        let responders: [UIResponder?] = [editingView, preparedResponder]
+        
+        for responder in responders {
+            if let responder = responder, responder.isFirstResponder {
+                return responder.textInputMode?.primaryLanguage
+            }
+        }
+        
+        return nil
+    }
+    
+    private func recordKeyboardFrame(for transition: KeyboardDodgerTransition) {
+        guard let window = view?.window, transition.endFrame.height > 0.0, geometry(for: transition).keyboardIsDockedAtEnd else {
             return
         }
         
-        if behavior(for: transition) == .updateAfterKeyboardChange {
-            resetConstraint(with: transition)
+        // Without an input mode, the frame is only recorded under the catch-all key
+        KeyboardDodgerHub.shared.recordKeyboardFrame(transition.endFrame, screen: window.screen, sizeClass: window.traitCollection.horizontalSizeClass, inputMode: currentInputMode)
+    }
+    
+    // MARK: Size transitions
+    
+    /// Call this from the view controller's `viewWillTransition(to:with:)`, so that keyboard changes arriving during a rotation or other size change
+    /// are folded into the transition coordinator's animation, and laid out in the same pass as the rest of the transition.
+    @objc public func viewWillTransition(to size: CGSize, with coordinator: UIViewControllerTransitionCoordinator) {
+        isAwaitingSizeTransition = true
+        cachedViewFrame = nil
+        
+        coordinator.animate(alongsideTransition: { [weak self] _ in
+            self?.performSizeTransitionAnimations()
+        }, completion: { [weak self] _ in
+            guard let self = self else {
+                return
+            }
+            
+            self.cachedViewFrame = nil
+            
+            // The alongside animations aren't run if the transition doesn't animate
+            self.performSizeTransitionAnimations()
+            
+            let completions = self.sizeTransitionCompletions
+            self.sizeTransitionCompletions = []
+            
+            for completion in completions {
+                completion()
+            }
+        })
+    }
+    
+    /// Whether a size transition's animation is about to start, and moves should wait to join it.
+    private var isAwaitingSizeTransition = false
+    
+    /// The latest move waiting for the size transition's animation. Earlier ones are superseded, so only the latest needs laying out.
+    private var sizeTransitionAnimations: (() -> Void)?
+    
+    /// The completion handlers of every move that joined the size transition, called in order once it has finished.
+    private var sizeTransitionCompletions: [() -> Void] = []
+    
+    private func performSizeTransitionAnimations() {
+        isAwaitingSizeTransition = false
+        
+        let animations = sizeTransitionAnimations
+        sizeTransitionAnimations = nil
+        animations?()
+    }
+    
+    // MARK: Interactive dismissal
+    
+    /// The keyboard's frame after the last update, if it's shown.
+    private var keyboardFrame: CGRect?
+    
+    /// The view's frame in screen space, measured once when the keyboard starts following an interactive dismissal. `nil` when not tracking.
+    private var interactiveDismissalViewFrame: CGRect?
+    
+    @objc private func interactiveDismissalPanDidChange(_ gestureRecognizer: UIPanGestureRecognizer) {
+        guard gestureRecognizer.state == .changed, let keyboardFrame = keyboardFrame, let view = view, let screen = view.window?.screen else {
+            return
+        }
+        
+        // Keyboard frames are in screen space. The keyboard only starts following the touch once the touch has been dragged down onto it.
+        let location = view.convert(gestureRecognizer.location(in: view), to: screen.coordinateSpace)
+        let offset = min(max(location.y - keyboardFrame.minY, 0.0), keyboardFrame.height)
+        
+        guard offset > 0.0 || interactiveDismissalViewFrame != nil else {
+            return
+        }
+        
+        let viewFrame = interactiveDismissalViewFrame ?? view.convert(view.bounds, to: screen.coordinateSpace)
+        
+        interactiveDismissalViewFrame = viewFrame
+        
+        let overlap = viewFrame.intersection(keyboardFrame.offsetBy(dx: 0.0, dy: offset)).height
+        let constant = overlap + self.constant
+        
+        var layoutViews: [UIView] = []
+        
+        if let transformView = transformView {
+            transformView.transform = CGAffineTransform(translationX: 0.0, y: constraintConstant - constant)
+        } else if let constraint = constraint, let layoutView = layoutView {
+            // Without a transform view there's nothing to move but the constraint, at the cost of a layout pass on every frame of the gesture
+            constraint.constant = constant
+            layoutViews.append(layoutView)
+        }
+        
+        // Only targets that don't need laying out follow the gesture. The rest, such as constraint targets, are left for the
+        // keyboard notification's move to commit, just like the dodger's own constraint when there's a transform view.
+        for target in targets where target.layoutView == nil {
+            target.keyboardDodger(self, avoidOverlap: overlap)
+        }
+        
+        for applier in appliers where applier.layoutView() == nil {
+            applier.apply(overlap)
+        }
+        
+        if let specializedApplier = specializedApplier, specializedApplier.layoutView() == nil {
+            specializedApplier.apply(overlap)
+        }
+        
+        for layoutView in layoutViews {
+            layoutView.layoutIfNeeded()
         }
     }
     
     // MARK: Private helpers
     
+    /// Watches the view for trait changes and resizes, so that `isFullScreen` only needs working out again when the size classes might have changed.
+    private lazy var observerView: KeyboardDodgerObserverView = KeyboardDodgerObserverView(dodger: self)
+    
+    /// Adds the observer view to the view, if it isn't there already.
+    ///
+    /// Nothing was watching the view while the observer view was gone, so the caches it would have invalidated are dropped and worked out again.
+    private func installObserverViewIfNeeded() {
+        guard let view = view else {
+            return
+        }
+        
+        // UIKit doesn't allow subviews directly on a visual effect view
+        let superview = (view as? UIVisualEffectView)?.contentView ?? view
+        
+        guard observerView.superview !== superview else {
+            return
+        }
+        
+        cachedIsFullScreen = nil
+        cachedViewFrame = nil
+        
+        observerView.frame = superview.bounds
+        superview.addSubview(observerView)
+    }
+    
+    /// The cached result of the form sheet check, or `nil` when it needs working out again.
+    private var cachedIsFullScreen: Bool?
+    
+    /// Whether the view fills its window's size class. Size classes only change with trait collections or window resizes, so this is cached until they do.
+    private var isFullScreen: Bool {
+        installObserverViewIfNeeded()
+        
+        if let isFullScreen = cachedIsFullScreen {
+            return isFullScreen
+        }
+        
+        // A view that has gone can't be in a form sheet, and there's nothing worth caching
+        guard let view = view else {
+            return true
+        }
+        
+        let isFullScreen = view.isFullScreen
+        cachedIsFullScreen = isFullScreen
+        return isFullScreen
+    }
+    
+    /// The constant the dodger is currently showing, whether through its constraint or through its transform view.
+    private var appliedConstant: CGFloat
+    
+    /// The constant the constraint currently holds, which the transform strategy translates relative to.
+    private var constraintConstant: CGFloat {
+        return constraint?.constant ?? constant
+    }
+    
+    /// Counts the moves, so a completion handler can tell whether its animation has since been superseded.
+    private var moveCount = 0
+    
+    /// Rounds a length to the nearest whole pixel on the view's display.
+    private func roundedToPixels(_ length: CGFloat) -> CGFloat {
+        let traitDisplayScale = view?.traitCollection.displayScale ?? 0.0
+        let displayScale = traitDisplayScale > 0.0 ? traitDisplayScale : view?.window?.screen.scale ?? 1.0
+        
+        return (length * displayScale).rounded() / displayScale
+    }
+    
     private func updateConstraint(with transition: KeyboardDodgerTransition) {
-        let constant = transition.finalConstraintHeight(for: view) + self.constant
+        let constant = roundedToPixels(geometry(for: transition).finalOverlap) + self.constant
+        
+        // Only the initial constant is compared exactly, so a dodger can always get back to where it started
+        let isChanged = constant == self.constant ? appliedConstant != constant : abs(appliedConstant - constant) > changeThreshold
         
-        guard constraint.constant != constant else {
+        guard isChanged || interactiveDismissalViewFrame != nil else {
+            KeyboardDodgerInstrumentation.shared.increment(.unchangedSkip)
             return
         }
         
-        constraint.constant = constant
+        let animations = move(to: constant)
+        let currentMove = moveCount
         
-        delegate?.keyboardDodger?(self, willUpdateConstraintWith: transition)
+        notify(.willUpdate, with: transition)
         
-        UIView.animate(withDuration: transition.animationDuration, delay: 0.0, options: .init(animationCurve: transition.animationCurve), animations: {
-            self.view.layoutIfNeeded()
-        }) { _ in
-            self.delegate?.keyboardDodger?(self, didUpdateConstraintWith: transition)
+        // The completion only keeps the payload, and only makes a transition again if there's anyone to tell
+        let payload = transition.payload
+        
+        animate(animations, with: transition) { [weak self] in
+            self?.commitTransformIfNeeded(after: currentMove)
+            
+            self?.notify(.didUpdate, with: KeyboardDodgerTransition(payload: payload))
         }
     }
     
     private func resetConstraint(with transition: KeyboardDodgerTransition) {
-        guard constraint.constant != constant else {
+        guard appliedConstant != constant || interactiveDismissalViewFrame != nil else {
+            KeyboardDodgerInstrumentation.shared.increment(.unchangedSkip)
             return
         }
         
-        constraint.constant = constant
+        let animations = move(to: constant)
+        let currentMove = moveCount
+        
+        notify(.willReset, with: transition)
+        
+        // The completion only keeps the payload, and only makes a transition again if there's anyone to tell
+        let payload = transition.payload
         
-        delegate?.keyboardDodger?(self, willResetConstraintWith: transition)
-        UIView.animate(withDuration: transition.animationDuration, delay: 0.0, options: .init(animationCurve: transition.animationCurve), animations: {
-            self.view.layoutIfNeeded()
-        }) { _ in
-            self.delegate?.keyboardDodger?(self, didResetConstraintWith: transition)
+        animate(animations, with: transition) { [weak self] in
+            self?.commitTransformIfNeeded(after: currentMove)
+            
+            self?.notify(.didReset, with: KeyboardDodgerTransition(payload: payload))
         }
     }
     
+    /// The animator running the dodger's current move. A move that arrives while it is still running retargets it, rather than stacking another animation on top.
+    private var animator: UIViewPropertyAnimator?
+    
+    private func animate(_ animations: @escaping () -> Void, with transition: KeyboardDodgerTransition, completion: @escaping () -> Void) {
+        if strategy == .deferred {
+            let currentMove = moveCount
+            
+            DispatchQueue.main.asyncAfter(deadline: .now() + transition.animationDuration) { [weak self] in
+                // A later move will set everything itself, and may finish sooner than this one
+                if currentMove == self?.moveCount {
+                    UIView.performWithoutAnimation(animations)
+                }
+                
+                completion()
+            }
+            
+            return
+        }
+        
+        if isAwaitingSizeTransition, animator?.state != .active {
+            sizeTransitionAnimations = animations
+            sizeTransitionCompletions.append(completion)
+            return
+        }
+        
+        guard let animator = animator, animator.state == .active else {
+            // The raw curve is passed through as it is, so the keyboard's private curve keeps the system's own timing
+            let animator = UIViewPropertyAnimator(duration: transition.animationDuration, curve: transition.animationCurve)
+            animator.addAnimations(animations)
+            animator.addCompletion { _ in
+                completion()
+            }
+            
+            self.animator = animator
+            animator.startAnimation()
+            return
+        }
+        
+        // Add the new end values to the running animation, and then let it run on with the new keyboard timing.
+        // Completion handlers are all called together, in order, when the animation finally finishes.
+        animator.pauseAnimation()
+        animator.addAnimations(animations)
+        animator.addCompletion { _ in
+            completion()
+        }
+        
+        guard transition.animationDuration > 0.0, animator.duration > 0.0, animator.fractionComplete < 1.0 else {
+            animator.stopAnimation(false)
+            animator.finishAnimation(at: .end)
+            return
+        }
+        
+        // The factor scales the animator's original duration, not the time it has left. The rest of the animation then runs on the new curve
+        // for the keyboard's whole duration, just as the keyboard's own animation starts afresh from wherever it was.
+        animator.continueAnimation(withTimingParameters: transition.timingParameters, durationFactor: CGFloat(transition.animationDuration / animator.duration))
+    }
+    
+    /// Moves the dodger to a new constant, and returns the animations that move the content on screen to match.
+    private func move(to constant: CGFloat) -> () -> Void {
+        appliedConstant = constant
+        moveCount += 1
+        
+        // Anything left over from following an interactive dismissal is folded into this move
+        let isTrackingInteractiveDismissal = interactiveDismissalViewFrame != nil
+        interactiveDismissalViewFrame = nil
+        
+        let overlap = constant - self.constant
+        let targets = self.targets
+        let appliers = self.appliers
+        let specializedApplier = self.specializedApplier
+        
+        var layoutViews = targets.compactMap { $0.layoutView } + appliers.compactMap { $0.layoutView() }
+        
+        if let layoutView = specializedApplier?.layoutView() {
+            layoutViews.append(layoutView)
+        }
+        var transform: (view: UIView, transform: CGAffineTransform)?
+        var deferredConstraint: NSLayoutConstraint?
+        
+        if strategy == .transform, let transformView = transformView {
+            // The constraint may hold a committed constant already, so translate relative to wherever it has left the view
+            transform = (view: transformView, transform: CGAffineTransform(translationX: 0.0, y: constraintConstant - constant))
+        } else {
+            if let constraint = constraint {
+                // A deferred constraint is left alone until the animations run, so no other layout pass picks it up in the meantime
+                if strategy == .deferred {
+                    deferredConstraint = constraint
+                } else {
+                    constraint.constant = constant
+                }
+                
+                if let layoutView = layoutView {
+                    layoutViews.append(layoutView)
+                }
+            }
+            
+            // Also undoes the transform strategy's translation, if the dodger has since degraded to another strategy
+            if let transformView = transformView, isTrackingInteractiveDismissal || transformView.transform != .identity {
+                transform = (view: transformView, transform: .identity)
+            }
+        }
+        
+        // Lay out each affected subtree exactly once, however many targets are in it.
+        // The animations may be held on to for a while, such as by a deferred move, so they only hold the views weakly.
+        let weakLayoutViews = KeyboardDodger.outermostViews(in: layoutViews).map { WeakReference(object: $0) }
+        let weakTransform = transform.map { (view: WeakReference(object: $0.view), transform: $0.transform) }
+        let weakDeferredConstraint = WeakReference(object: deferredConstraint)
+        
+        return { [weak self] in
+            guard let self = self else {
+                return
+            }
+            
+            let duration = KeyboardDodgerInstrumentation.shared.layout(measuring: self.layoutBudget > 0.0) {
+                weakDeferredConstraint.object?.constant = constant
+                
+                if let transform = weakTransform {
+                    transform.view.object?.transform = transform.transform
+                }
+                
+                for target in targets {
+                    target.keyboardDodger(self, avoidOverlap: overlap)
+                }
+                
+                for applier in appliers {
+                    applier.apply(overlap)
+                }
+                
+                specializedApplier?.apply(overlap)
+                
+                for layoutView in weakLayoutViews {
+                    layoutView.object?.layoutIfNeeded()
+                }
+            }
+            
+            if let duration = duration, self.layoutBudget > 0.0, duration > self.layoutBudget {
+                self.recordOverBudgetLayout(taking: duration)
+            }
+        }
+    }
+    
+    /// The slowest layout pass over budget since the dodger last degraded, waiting to be acted on once the animation block has closed.
+    private var overBudgetLayoutDuration: TimeInterval?
+    
+    /// Called from inside the animation block, where anything the delegate changed would be animated along with the move,
+    /// so the dodger degrades straight after it instead. Several passes over budget before then only degrade the dodger once.
+    private func recordOverBudgetLayout(taking duration: TimeInterval) {
+        if let overBudgetLayoutDuration = overBudgetLayoutDuration {
+            self.overBudgetLayoutDuration = max(overBudgetLayoutDuration, duration)
+            return
+        }
+        
+        overBudgetLayoutDuration = duration
+        
+        DispatchQueue.main.async { [weak self] in
+            guard let self = self, let duration = self.overBudgetLayoutDuration else {
+                return
+            }
+            
+            self.overBudgetLayoutDuration = nil
+            self.degrade(afterLayoutTaking: duration)
+        }
+    }
+    
+    /// Switches to the next cheaper strategy, if there is one, and tells the delegate.
+    private func degrade(afterLayoutTaking duration: TimeInterval) {
+        switch strategy {
+        case .constraint where transformView != nil:
+            strategy = .transform
+        case .constraint, .transform:
+            strategy = .deferred
+        case .deferred:
+            return
+        }
+        
+        KeyboardDodgerInstrumentation.shared.interval("Delegate") {
+            if delegateMethods.contains(.degrade) {
+                delegate?.keyboardDodger?(self, didDegradeTo: strategy, afterLayoutTaking: duration)
+            }
+            
+            onDegrade?(strategy, duration)
+        }
+    }
+    
+    /// A weak reference to an object, for holding on to views from closures that may outlive them.
+    private struct WeakReference<Object: AnyObject> {
+        
+        weak var object: Object?
+        
+    }
+    
+    /// An applier wrapped up in closures, so appliers of different types can share an array.
+    ///
+    /// The initializer is inlinable, so when it's called from somewhere the applier's type is known, such as `KeyboardDodgerOf`'s initializer,
+    /// the closures are specialized for that type, and call the applier directly.
+    @usableFromInline internal struct AnyApplier {
+        
+        @usableFromInline let layoutView: () -> UIView?
+        
+        @usableFromInline let apply: (CGFloat) -> Void
+        
+        @inlinable init<Applier: KeyboardDodgerApplier>(_ applier: Applier) {
+            self.layoutView = { applier.layoutView }
+            self.apply = { applier.apply(overlap: $0) }
+        }
+        
+    }
+    
+    /// Drops any views that will be laid out anyway as part of another view in the list.
+    private static func outermostViews(in views: [UIView]) -> [UIView] {
+        var outermostViews: [UIView] = []
+        
+        for view in views where outermostViews.contains(where: { view.isDescendant(of: $0) }) == false {
+            outermostViews.removeAll { $0.isDescendant(of: view) }
+            outermostViews.append(view)
+        }
+        
+        return outermostViews
+    }
+    
+    /// Swaps the transform view's transform for the equivalent constraint constant, unless another move has started since.
+    private func commitTransformIfNeeded(after move: Int) {
+        guard commitsTransformToConstraint, move == moveCount, let transformView = transformView, transformView.transform != .identity else {
+            return
+        }
+        
+        UIView.performWithoutAnimation {
+            transformView.transform = .identity
+            if let constraint = constraint {
+                constraint.constant = appliedConstant
+                layoutView?.layoutIfNeeded()
+            }
+        }
+    }
+    
+    // MARK: Delegate
+    
+    /// The optional delegate methods the delegate implements, worked out once whenever the delegate is set,
+    /// rather than checking whether it responds to each one on every keyboard event.
+    private struct DelegateMethods: OptionSet {
+        
+        let rawValue: Int
+        
+        static let willUpdate = DelegateMethods(rawValue: 1 << 0)
+        
+        static let didUpdate = DelegateMethods(rawValue: 1 << 1)
+        
+        static let willReset = DelegateMethods(rawValue: 1 << 2)
+        
+        static let didReset = DelegateMethods(rawValue: 1 << 3)
+        
+        static let behavior = DelegateMethods(rawValue: 1 << 4)
+        
+        static let degrade = DelegateMethods(rawValue: 1 << 5)
+        
+        init(rawValue: Int) {
+            self.rawValue = rawValue
+        }
+        
+        init(delegate: KeyboardDodgerDelegate?) {
+            guard let delegate = delegate else {
+                self = []
+                return
+            }
+            
+            // Every Objective-C object conforms to NSObjectProtocol, but if this somehow fails, fall back to asking each time
+            guard let object = delegate as? NSObjectProtocol else {
+                self = [.willUpdate, .didUpdate, .willReset, .didReset, .behavior, .degrade]
+                return
+            }
+            
+            var methods: DelegateMethods = []
+            
+            if object.responds(to: #selector(KeyboardDodgerDelegate.keyboardDodger(_:willUpdateConstraintWith:))) {
+                methods.insert(.willUpdate)
+            }
+            
+            if object.responds(to: #selector(KeyboardDodgerDelegate.keyboardDodger(_:didUpdateConstraintWith:))) {
+                methods.insert(.didUpdate)
+            }
+            
+            if object.responds(to: #selector(KeyboardDodgerDelegate.keyboardDodger(_:willResetConstraintWith:))) {
+                methods.insert(.willReset)
+            }
+            
+            if object.responds(to: #selector(KeyboardDodgerDelegate.keyboardDodger(_:didResetConstraintWith:))) {
+                methods.insert(.didReset)
+            }
+            
+            if object.responds(to: #selector(KeyboardDodgerDelegate.keyboardDodger(_:behaviorFor:))) {
+                methods.insert(.behavior)
+            }
+            
+            if object.responds(to: #selector(KeyboardDodgerDelegate.keyboardDodger(_:didDegradeTo:afterLayoutTaking:))) {
+                methods.insert(.degrade)
+            }
+            
+            self = methods
+        }
+        
+    }
+    
+    private var delegateMethods: DelegateMethods
+    
+    /// Sends a message to the delegate, if it implements it, and then to the matching callback.
+    ///
+    /// The transition is only evaluated if the delegate implements the method or the callback is set.
+    private func notify(_ method: DelegateMethods, with transition: @autoclosure () -> KeyboardDodgerTransition) {
+        let delegate = delegateMethods.contains(method) ? self.delegate : nil
+        
+        let callback: ((KeyboardDodgerTransition) -> Void)?
+        
+        switch method {
+        case .willUpdate:
+            callback = onWillUpdate
+        case .didUpdate:
+            callback = onDidUpdate
+        case .willReset:
+            callback = onWillReset
+        case .didReset:
+            callback = onDidReset
+        default:
+            callback = nil
+        }
+        
+        guard delegate != nil || callback != nil else {
+            return
+        }
+        
+        let transition = transition()
+        
+        KeyboardDodgerInstrumentation.shared.interval("Delegate") {
+            switch method {
+            case .willUpdate:
+                delegate?.keyboardDodger?(self, willUpdateConstraintWith: transition)
+            case .didUpdate:
+                delegate?.keyboardDodger?(self, didUpdateConstraintWith: transition)
+            case .willReset:
+                delegate?.keyboardDodger?(self, willResetConstraintWith: transition)
+            case .didReset:
+                delegate?.keyboardDodger?(self, didResetConstraintWith: transition)
+            default:
+                break
+            }
+            
+            callback?(transition)
+        }
+    }
+    
+    // MARK: Behavior
+    
     private func behavior(for transition: KeyboardDodgerTransition) -> KeyboardDodgerBehavior {
-        if let behavior = delegate?.keyboardDodger?(self, behaviorFor: transition) {
+        if let behavior = behaviorProvider?(transition) {
+            return behavior
+        }
+        
+        if delegateMethods.contains(.behavior), let behavior = delegate?.keyboardDodger?(self, behaviorFor: transition) {
             return behavior
         }
         
         // If we're inside a form sheet and the keyboard height is expanding, animate the text view constraints
         // only *after* the keyboard has changed, as the form sheet may move underneath the keyboard
-        if view.isFullScreen == false && transition.isExpanding(in: view) {
+        if isFullScreen == false && geometry(for: transition).isExpanding {
             return .updateAfterKeyboardChange
         }
         
@@ -286,10 +1331,11 @@ import UIKit
 
 // MARK: - Private helpers
 
-extension UITraitEnvironment {
+extension UIView {
     
+    /// Uses the view's own window rather than the key window, which is both cheaper and correct when an app has several windows or scenes.
     fileprivate var isFullScreen: Bool {
-        guard let windowTraitCollection = UIApplication.shared.keyWindow?.traitCollection else {
+        guard let windowTraitCollection = window?.traitCollection else {
             return true
         }
         
@@ -303,21 +1349,36 @@ extension UITraitEnvironment {
     
 }
 
-extension UIView.AnimationOptions {
-    
-    fileprivate init(animationCurve: UIView.AnimationCurve) {
-        switch animationCurve {
-        case .easeInOut:
-            self = .curveEaseInOut
-        case .easeIn:
-            self = .curveEaseIn
-        case .easeOut:
-            self = .curveEaseOut
-        case .linear:
-            self = .curveLinear
-        default:
-            self = .curveEaseInOut
+extension NSLayoutConstraint {
+    
+    /// The nearest view that contains both of the constraint's items, i.e. the smallest subtree whose layout the constraint can change.
+    ///
+    /// A view's own frame is set by its superview, so a constraint with only one item resolves to that item's superview.
+    internal var nearestCommonAncestor: UIView? {
+        guard let firstView = NSLayoutConstraint.layoutView(for: firstItem) else {
+            return nil
+        }
+        
+        guard let secondView = NSLayoutConstraint.layoutView(for: secondItem), secondView !== firstView else {
+            return firstView.superview ?? firstView
         }
+        
+        var ancestor: UIView? = firstView
+        
+        while let candidate = ancestor {
+            if secondView.isDescendant(of: candidate) {
+                return candidate
+            }
+            
+            ancestor = candidate.superview
+        }
+        
+        return nil
+    }
+    
+    /// The view that lays out a constraint item, which is either the item itself or the view that owns the layout guide.
+    private static func layoutView(for item: AnyObject?) -> UIView? {
+        return (item as? UIView) ?? (item as? UILayoutGuide)?.owningView
     }
     
 }
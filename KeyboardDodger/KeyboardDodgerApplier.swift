@@ -0,0 +1,168 @@
+//
+//  KeyboardDodgerApplier.swift
+//  KeyboardDodger
+//
+//  Copyright (c) 2026 Trade Me. All rights reserved.
+//
+
+import UIKit
+
+// MARK: Keyboard dodger applier
+
+/// The Swift-only counterpart to `KeyboardDodgerTarget`, for moving something out of the way of the keyboard with no Objective-C message send.
+///
+/// Appliers are added to a dodger with `add(_:)`, and each one's `apply(overlap:)` is called as a Swift function from within the dodger's animation,
+/// rather than sent as a message. A `KeyboardDodgerOf` goes further, and calls its single applier without dynamic dispatch at all.
+/// Appliers can be structs, and custom ones are cheap to write.
+public protocol KeyboardDodgerApplier {
+    
+    /// The view that needs laying out once the applier has been applied, if any.
+    var layoutView: UIView? { get }
+    
+    /// Called inside the dodger's animation block to move out of the way of a keyboard overlapping the dodger's view by `overlap` points.
+    /// The overlap is zero when the keyboard is hidden, and whatever was moved should go back to where it started.
+    func apply(overlap: CGFloat)
+    
+}
+
+// MARK: - Keyboard dodger constraint applier
+
+/// An applier that moves a constraint's constant by the keyboard's overlap, plus an offset.
+public struct KeyboardDodgerConstraintApplier: KeyboardDodgerApplier {
+    
+    /// The constraint to adjust, held weakly so the applier doesn't keep it alive.
+    public private(set) weak var constraint: NSLayoutConstraint?
+    
+    /// Added to the overlap while the keyboard overlaps the dodger's view.
+    public let offset: CGFloat
+    
+    /// The initial value for the constraint. Used to reset the constraint's constant back to its initial value.
+    private let constant: CGFloat
+    
+    public init(constraint: NSLayoutConstraint, offset: CGFloat = 0.0) {
+        self.constraint = constraint
+        self.offset = offset
+        self.constant = constraint.constant
+    }
+    
+    /// The nearest common ancestor of the constraint's items, which is the smallest subtree the constraint can move.
+    public var layoutView: UIView? {
+        return constraint?.nearestCommonAncestor
+    }
+    
+    public func apply(overlap: CGFloat) {
+        constraint?.constant = overlap > 0.0 ? constant + overlap + offset : constant
+    }
+    
+}
+
+// MARK: - Keyboard dodger transform applier
+
+/// An applier that translates a view up by the keyboard's overlap, plus an offset, without needing a layout pass.
+public struct KeyboardDodgerTransformApplier: KeyboardDodgerApplier {
+    
+    /// The view to translate, held weakly so the applier doesn't keep it alive. Its transform is replaced while the keyboard is shown.
+    public private(set) weak var view: UIView?
+    
+    /// Added to the overlap while the keyboard overlaps the dodger's view.
+    public let offset: CGFloat
+    
+    public init(view: UIView, offset: CGFloat = 0.0) {
+        self.view = view
+        self.offset = offset
+    }
+    
+    /// Transforms don't need laying out.
+    public var layoutView: UIView? {
+        return nil
+    }
+    
+    public func apply(overlap: CGFloat) {
+        view?.transform = overlap > 0.0 ? CGAffineTransform(translationX: 0.0, y: -(overlap + offset)) : .identity
+    }
+    
+}
+
+// MARK: - Keyboard dodger scroll view applier
+
+/// An applier that keeps a scroll view's content clear of the keyboard by growing its bottom content and scroll indicator insets.
+///
+/// Unlike shrinking the scroll view with a constraint, this leaves the scroll view's bounds alone, so table and collection views don't
+/// invalidate their layouts or re-layout their visible cells as the keyboard is shown.
+public struct KeyboardDodgerScrollViewApplier: KeyboardDodgerApplier {
+    
+    /// The scroll view to adjust, held weakly so the applier doesn't keep it alive.
+    public private(set) weak var scrollView: UIScrollView?
+    
+    /// Added to the overlap while the keyboard overlaps the dodger's view.
+    public let offset: CGFloat
+    
+    /// The initial bottom content inset. Used to reset the inset back to its initial value.
+    private let contentInset: CGFloat
+    
+    /// The initial bottom scroll indicator inset. Used to reset the inset back to its initial value.
+    private let scrollIndicatorInset: CGFloat
+    
+    public init(scrollView: UIScrollView, offset: CGFloat = 0.0) {
+        self.scrollView = scrollView
+        self.offset = offset
+        self.contentInset = scrollView.contentInset.bottom
+        self.scrollIndicatorInset = scrollView.bottomScrollIndicatorInset
+    }
+    
+    /// Insets don't need laying out.
+    public var layoutView: UIView? {
+        return nil
+    }
+    
+    public func apply(overlap: CGFloat) {
+        guard let scrollView = scrollView else {
+            return
+        }
+        
+        // The part of the overlap that's covered by the safe area has already been inset by the system
+        let inset = overlap > 0.0 ? max(overlap - scrollView.systemBottomInset, 0.0) + offset : 0.0
+        
+        scrollView.contentInset.bottom = contentInset + inset
+        scrollView.bottomScrollIndicatorInset = scrollIndicatorInset + inset
+    }
+    
+}
+
+// MARK: - Private helpers
+
+extension UIScrollView {
+    
+    /// The bottom inset the system adds to the content inset, such as for the safe area.
+    fileprivate var systemBottomInset: CGFloat {
+        if #available(iOS 11.0, *) {
+            return adjustedContentInset.bottom - contentInset.bottom
+        }
+        
+        return 0.0
+    }
+    
+    /// The bottom inset of the vertical scroll indicator.
+    fileprivate var bottomScrollIndicatorInset: CGFloat {
+        get {
+            #if compiler(>=5.1)
+            if #available(iOS 13.0, *) {
+                return verticalScrollIndicatorInsets.bottom
+            }
+            #endif
+            
+            return scrollIndicatorInsets.bottom
+        }
+        set {
+            #if compiler(>=5.1)
+            if #available(iOS 13.0, *) {
+                verticalScrollIndicatorInsets.bottom = newValue
+                return
+            }
+            #endif
+            
+            scrollIndicatorInsets.bottom = newValue
+        }
+    }
+    
+}
@@ -0,0 +1,37 @@
+//
+//  KeyboardDodgerConcurrency.swift
+//  KeyboardDodger
+//
+//  Copyright (c) 2026 Trade Me. All rights reserved.
+//
+
+import UIKit
+
+#if compiler(>=5.5) && canImport(_Concurrency)
+
+// MARK: Keyboard dodger transitions
+
+@available(iOS 13.0, *)
+extension KeyboardDodger {
+    
+    /// A stream of the transition for every keyboardWillChangeFrame notification, which is sent as the keyboard is shown, hidden or resized.
+    ///
+    /// The stream is backed by the same process-wide observer as every keyboard dodger, so each notification is only observed and parsed once
+    /// however many consumers there are. Transitions are delivered on the main actor, and observing stops when the stream's task is cancelled.
+    @MainActor public static var transitions: AsyncStream<KeyboardDodgerTransition> {
+        return AsyncStream { continuation in
+            let token = KeyboardDodgerHub.shared.addTransitionObserver { transition in
+                continuation.yield(transition)
+            }
+            
+            continuation.onTermination = { _ in
+                DispatchQueue.main.async {
+                    KeyboardDodgerHub.shared.removeTransitionObserver(token)
+                }
+            }
+        }
+    }
+    
+}
+
+#endif
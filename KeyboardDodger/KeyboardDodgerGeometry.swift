@@ -0,0 +1,79 @@
+//
+//  KeyboardDodgerGeometry.swift
+//  KeyboardDodger
+//
+//  Copyright (c) 2026 Trade Me. All rights reserved.
+//
+
+import UIKit
+
+// MARK: Keyboard dodger geometry
+
+/// The overlap calculations behind a keyboard transition, done on plain rects in screen space, which is the space keyboard frames are given in.
+///
+/// KeyboardDodgerTransition is a thin wrapper around this. As a value type with no references to UIKit objects, the geometry can be
+/// inlined and specialized by the compiler, computed without any allocation or message sends, and benchmarked in isolation.
+public struct KeyboardDodgerGeometry: Equatable {
+    
+    /// The view's frame in screen space, or `CGRect.null` if the view isn't in a window.
+    public var viewFrame: CGRect
+    
+    /// The bounds of the screen the keyboard is shown on.
+    public var screenBounds: CGRect
+    
+    /// The keyboard's frame at the start of the transition.
+    public var startFrame: CGRect
+    
+    /// The keyboard's frame at the end of the transition.
+    public var endFrame: CGRect
+    
+    @inlinable public init(viewFrame: CGRect, screenBounds: CGRect, startFrame: CGRect, endFrame: CGRect) {
+        self.viewFrame = viewFrame
+        self.screenBounds = screenBounds
+        self.startFrame = startFrame
+        self.endFrame = endFrame
+    }
+    
+    /// Whether the keyboard is docked to the bottom of the screen at the start of the transition.
+    @inlinable public var keyboardIsDockedAtStart: Bool {
+        return screenBounds.maxY == startFrame.maxY
+    }
+    
+    /// Whether the keyboard is docked to the bottom of the screen at the end of the transition.
+    @inlinable public var keyboardIsDockedAtEnd: Bool {
+        return screenBounds.maxY == endFrame.maxY
+    }
+    
+    /// The height of the overlap between the view and the keyboard at the start of the transition.
+    ///
+    /// An undocked (floating or split) keyboard never overlaps, as there is nothing sensible to move the view out of the way of.
+    @inlinable public var initialOverlap: CGFloat {
+        guard keyboardIsDockedAtStart else {
+            return 0.0
+        }
+        
+        return viewFrame.intersection(startFrame).height
+    }
+    
+    /// The height of the overlap between the view and the keyboard at the end of the transition.
+    ///
+    /// An undocked (floating or split) keyboard never overlaps, as there is nothing sensible to move the view out of the way of.
+    @inlinable public var finalOverlap: CGFloat {
+        guard keyboardIsDockedAtEnd else {
+            return 0.0
+        }
+        
+        return viewFrame.intersection(endFrame).height
+    }
+    
+    /// Whether the overlap between the view and the keyboard grows over the transition.
+    @inlinable public var isExpanding: Bool {
+        return initialOverlap < finalOverlap
+    }
+    
+    /// Whether the overlap between the view and the keyboard shrinks over the transition.
+    @inlinable public var isCollapsing: Bool {
+        return initialOverlap > finalOverlap
+    }
+    
+}
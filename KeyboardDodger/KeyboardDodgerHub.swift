@@ -0,0 +1,338 @@
+//
+//  KeyboardDodgerHub.swift
+//  KeyboardDodger
+//
+//  Copyright (c) 2026 Trade Me. All rights reserved.
+//
+
+import UIKit
+
+// MARK: Keyboard dodger event
+
+/// The keyboard notifications that a keyboard dodger responds to.
+internal enum KeyboardDodgerEvent {
+    
+    /// Equivalent to UIKeyboardWillChangeFrameNotification.
+    case willChangeFrame
+    
+    /// Equivalent to UIKeyboardDidChangeFrameNotification.
+    case didChangeFrame
+    
+    /// Equivalent to UIKeyboardWillHideNotification.
+    case willHide
+    
+    /// Equivalent to UIKeyboardDidHideNotification.
+    case didHide
+    
+    /// The event sent once the keyboard has finished the change this event announces, or `nil` if this is that event.
+    var completion: KeyboardDodgerEvent? {
+        switch self {
+        case .willChangeFrame:
+            return .didChangeFrame
+        case .willHide:
+            return .didHide
+        case .didChangeFrame, .didHide:
+            return nil
+        }
+    }
+    
+}
+
+// MARK: - Keyboard dodger hub
+
+/// Observes the keyboard notifications once for the whole process, and fans each one out to every registered keyboard dodger.
+///
+/// Dodgers are held weakly, so they drop out of the registry by themselves when they are deallocated.
+internal final class KeyboardDodgerHub: NSObject {
+    
+    /// The process-wide hub.
+    static let shared = KeyboardDodgerHub()
+    
+    /// The registered keyboard dodgers.
+    private let dodgers = NSHashTable<KeyboardDodger>.weakObjects()
+    
+    /// The dodgers waiting for editing to begin inside their views, which aren't sent any keyboard notifications in the meantime.
+    private let dormantDodgers = NSHashTable<KeyboardDodger>.weakObjects()
+    
+    /// The dodgers with coalesced keyboard changes waiting for the next display frame.
+    private let pendingDodgers = NSHashTable<KeyboardDodger>.weakObjects()
+    
+    /// Fires once on the next display frame while any dodgers are pending, and is torn down again straight away.
+    private var displayLink: CADisplayLink?
+    
+    private override init() {
+        super.init()
+        
+        NotificationCenter.default.addObserver(self, selector: #selector(keyboardWillChangeFrame(_:)), name: UIResponder.keyboardWillChangeFrameNotification, object: nil)
+        NotificationCenter.default.addObserver(self, selector: #selector(keyboardDidChangeFrame(_:)), name: UIResponder.keyboardDidChangeFrameNotification, object: nil)
+        NotificationCenter.default.addObserver(self, selector: #selector(keyboardWillHide(_:)), name: UIResponder.keyboardWillHideNotification, object: nil)
+        NotificationCenter.default.addObserver(self, selector: #selector(keyboardDidHide(_:)), name: UIResponder.keyboardDidHideNotification, object: nil)
+        
+        // Editing begins before the keyboard is brought up, so these wake dormant dodgers in time for its notifications
+        NotificationCenter.default.addObserver(self, selector: #selector(editingDidBegin(_:)), name: UITextField.textDidBeginEditingNotification, object: nil)
+        NotificationCenter.default.addObserver(self, selector: #selector(editingDidBegin(_:)), name: UITextView.textDidBeginEditingNotification, object: nil)
+        NotificationCenter.default.addObserver(self, selector: #selector(editingDidEnd(_:)), name: UITextField.textDidEndEditingNotification, object: nil)
+        NotificationCenter.default.addObserver(self, selector: #selector(editingDidEnd(_:)), name: UITextView.textDidEndEditingNotification, object: nil)
+    }
+    
+    // MARK: Registration
+    
+    /// Starts forwarding keyboard notifications to the dodger.
+    func register(_ dodger: KeyboardDodger) {
+        updateRegistration(of: dodger)
+    }
+    
+    /// Stops forwarding keyboard notifications to the dodger.
+    func unregister(_ dodger: KeyboardDodger) {
+        dodgers.remove(dodger)
+        dormantDodgers.remove(dodger)
+    }
+    
+    /// Moves the dodger between the registered and dormant dodgers, to match whether it's dormant.
+    func updateRegistration(of dodger: KeyboardDodger) {
+        if dodger.isDormant {
+            // A dormant dodger isn't sent the will events, so anything decided before it went to sleep would be stale by the time it wakes
+            dodger.discardDecision(for: .didChangeFrame)
+            dodger.discardDecision(for: .didHide)
+            
+            dodgers.remove(dodger)
+            dormantDodgers.add(dodger)
+        } else {
+            dormantDodgers.remove(dodger)
+            dodgers.add(dodger)
+        }
+    }
+    
+    /// Sends any dodgers that have nothing left to do back to sleep.
+    private func updateRegistrations() {
+        for dodger in dodgers.allObjects where dodger.isDormant {
+            updateRegistration(of: dodger)
+        }
+    }
+    
+    // MARK: Observers
+    
+    /// Closures called with the transition of every keyboardWillChangeFrame notification, keyed by the token returned when they were added.
+    private var transitionObservers: [Int: (KeyboardDodgerTransition) -> Void] = [:]
+    
+    /// The token for the next transition observer.
+    private var nextTransitionObserverToken = 0
+    
+    /// Starts calling the closure with the transition of every keyboardWillChangeFrame notification, parsed once and shared with the dodgers.
+    /// Returns a token for removing the observer again.
+    func addTransitionObserver(_ observer: @escaping (KeyboardDodgerTransition) -> Void) -> Int {
+        let token = nextTransitionObserverToken
+        nextTransitionObserverToken += 1
+        
+        transitionObservers[token] = observer
+        return token
+    }
+    
+    /// Stops calling the closure added with the token.
+    func removeTransitionObserver(_ token: Int) {
+        transitionObservers[token] = nil
+    }
+    
+    // MARK: Prediction
+    
+    /// The conditions a docked keyboard's frame depends on.
+    private struct KeyboardFrameKey: Hashable {
+        
+        /// The screen's size, which changes with the interface orientation.
+        var screenSize: CGSize
+        
+        /// The horizontal size class of the window the keyboard was shown over.
+        var sizeClass: UIUserInterfaceSizeClass
+        
+        /// The primary language of the keyboard's input mode, if known.
+        var inputMode: String?
+        
+        func hash(into hasher: inout Hasher) {
+            hasher.combine(screenSize.width)
+            hasher.combine(screenSize.height)
+            hasher.combine(sizeClass)
+            hasher.combine(inputMode)
+        }
+        
+    }
+    
+    /// The last docked keyboard frame seen in each set of conditions.
+    private var keyboardFrames: [KeyboardFrameKey: CGRect] = [:]
+    
+    /// Remembers a docked keyboard's frame, which is recorded under any input mode as well as under the given one.
+    func recordKeyboardFrame(_ frame: CGRect, screen: UIScreen, sizeClass: UIUserInterfaceSizeClass, inputMode: String?) {
+        let screenSize = screen.bounds.size
+        
+        keyboardFrames[KeyboardFrameKey(screenSize: screenSize, sizeClass: sizeClass, inputMode: nil)] = frame
+        
+        if inputMode != nil {
+            keyboardFrames[KeyboardFrameKey(screenSize: screenSize, sizeClass: sizeClass, inputMode: inputMode)] = frame
+        }
+    }
+    
+    /// The last docked keyboard frame seen in the same conditions, falling back to any input mode if there isn't one for the given input mode.
+    func predictedKeyboardFrame(screen: UIScreen, sizeClass: UIUserInterfaceSizeClass, inputMode: String?) -> CGRect? {
+        let screenSize = screen.bounds.size
+        
+        return keyboardFrames[KeyboardFrameKey(screenSize: screenSize, sizeClass: sizeClass, inputMode: inputMode)] ?? keyboardFrames[KeyboardFrameKey(screenSize: screenSize, sizeClass: sizeClass, inputMode: nil)]
+    }
+    
+    // MARK: Coalescing
+    
+    /// Asks the hub to flush the dodger's pending keyboard change on the next display frame.
+    func setNeedsFlush(_ dodger: KeyboardDodger) {
+        pendingDodgers.add(dodger)
+        
+        guard displayLink == nil else {
+            return
+        }
+        
+        let displayLink = CADisplayLink(target: self, selector: #selector(displayLinkDidFire(_:)))
+        displayLink.add(to: .main, forMode: .common)
+        self.displayLink = displayLink
+    }
+    
+    @objc private func displayLinkDidFire(_ displayLink: CADisplayLink) {
+        displayLink.invalidate()
+        self.displayLink = nil
+        
+        let dodgers = pendingDodgers.allObjects
+        pendingDodgers.removeAllObjects()
+        
+        for dodger in dodgers {
+            dodger.flushPendingAction()
+        }
+    }
+    
+    // MARK: Notifications
+    
+    @objc private func keyboardWillChangeFrame(_ notification: Notification) {
+        dispatch(.willChangeFrame, for: notification)
+    }
+    
+    @objc private func keyboardDidChangeFrame(_ notification: Notification) {
+        dispatch(.didChangeFrame, for: notification)
+    }
+    
+    @objc private func keyboardWillHide(_ notification: Notification) {
+        dispatch(.willHide, for: notification)
+    }
+    
+    @objc private func keyboardDidHide(_ notification: Notification) {
+        dispatch(.didHide, for: notification)
+    }
+    
+    @objc private func editingDidBegin(_ notification: Notification) {
+        guard dormantDodgers.count > 0, let editingView = notification.object as? UIView else {
+            return
+        }
+        
+        for dodger in dormantDodgers.allObjects {
+            // Dormant dodgers never reach the pruning in dispatch, so one that has outlived its view is dropped here instead
+            guard let view = dodger.view else {
+                unregister(dodger)
+                continue
+            }
+            
+            guard editingView.isDescendant(of: view) else {
+                continue
+            }
+            
+            dodger.editingView = editingView
+            updateRegistration(of: dodger)
+        }
+    }
+    
+    @objc private func editingDidEnd(_ notification: Notification) {
+        updateRegistrations()
+    }
+    
+    // MARK: Private helpers
+    
+    private func dispatch(_ event: KeyboardDodgerEvent, for notification: Notification) {
+        var offScreenSkipCount = 0
+        var decidedSkipCount = 0
+        
+        // Take a snapshot, as dodgers may be added or removed by their delegates while we're iterating.
+        // Dodgers that are hidden or off screen drop out here, before the notification is even parsed.
+        let dodgers = self.dodgers.allObjects.filter { dodger in
+            // A dodger that has outlived its view has nothing left to move, so it drops out of the registry for good
+            if dodger.view == nil {
+                unregister(dodger)
+                return false
+            }
+            
+            if event.completion == nil, dodger.consumeDecision(for: event) {
+                decidedSkipCount += 1
+                return false
+            }
+            
+            if dodger.isListening(for: event) == false {
+                dodger.discardDecision(for: event)
+                offScreenSkipCount += 1
+                return false
+            }
+            
+            return true
+        }
+        
+        let instrumentation = KeyboardDodgerInstrumentation.shared
+        instrumentation.increment(.notification)
+        instrumentation.increment(.offScreenSkip, by: offScreenSkipCount)
+        instrumentation.increment(.decidedSkip, by: decidedSkipCount)
+        
+        let observers = event == .willChangeFrame ? Array(transitionObservers.values) : []
+        
+        guard dodgers.isEmpty == false || observers.isEmpty == false else {
+            return
+        }
+        
+        guard let userInfo = notification.userInfo, let payload = instrumentation.interval("Parse", { KeyboardDodgerPayload(dictionary: userInfo) }) else {
+            for dodger in dodgers {
+                dodger.discardDecision(for: event)
+            }
+            
+            return
+        }
+        
+        // Every dodger shares the one transition, so each notification is parsed and allocated exactly once
+        let transition = KeyboardDodgerTransition(payload: payload)
+        
+        // Dragging a floating or split keyboard around sends a frame change for every step, none of which can overlap anything.
+        // Only changes that dock or undock the keyboard, or move a docked one, reach the dodgers. Hides always do, so a dodger
+        // that missed the keyboard undocking while it was off screen still gets reset.
+        if event == .willChangeFrame || event == .didChangeFrame, isDocked(payload.startFrame) == false, isDocked(payload.endFrame) == false {
+            instrumentation.increment(.undockedSkip)
+            
+            for dodger in dodgers {
+                dodger.discardDecision(for: event)
+            }
+            
+            for observer in observers {
+                observer(transition)
+            }
+            
+            return
+        }
+        
+        for dodger in dodgers {
+            dodger.handle(event, with: transition)
+        }
+        
+        for observer in observers {
+            observer(transition)
+        }
+        
+        // Dodgers that were kept awake to put their constraint back can go back to sleep once the keyboard has finished moving
+        if event.completion == nil {
+            updateRegistrations()
+        }
+    }
+    
+    /// Whether the keyboard frame, in screen coordinates, is docked to the bottom of one of the screens, matching `KeyboardDodgerGeometry`.
+    /// Floating and split keyboards sit clear of the bottom edge, and a hidden keyboard sits below it.
+    private func isDocked(_ keyboardFrame: CGRect) -> Bool {
+        return UIScreen.screens.contains { $0.bounds.maxY == keyboardFrame.maxY }
+    }
+    
+}
@@ -0,0 +1,153 @@
+//
+//  KeyboardDodgerInstrumentation.swift
+//  KeyboardDodger
+//
+//  Copyright (c) 2026 Trade Me. All rights reserved.
+//
+
+import UIKit
+import os
+
+// MARK: Keyboard dodger instrumentation
+
+/// Opt-in instrumentation for every keyboard dodger in the process.
+///
+/// When enabled, the parsing, geometry, behavior, delegate and layout work for each keyboard event is wrapped in `os_signpost` intervals
+/// (on iOS 12 and later) that show up under Points of Interest in Instruments, and aggregate counters are kept for shipping to dashboards.
+/// When disabled, which is the default, it costs a single check per interval.
+@objc public final class KeyboardDodgerInstrumentation: NSObject {
+    
+    /// The process-wide instrumentation.
+    @objc public static let shared = KeyboardDodgerInstrumentation()
+    
+    private override init() {
+        super.init()
+    }
+    
+    /// Whether to record signposts and counters. Defaults to `false`.
+    @objc public var isEnabled: Bool = false
+    
+    /// The upper bounds of the layout duration histogram's buckets, in seconds. The last bucket counts anything slower.
+    @objc public static let layoutDurationBucketBounds: [TimeInterval] = [0.001, 0.002, 0.004, 0.008, 0.016, 0.033]
+    
+    // MARK: Counters
+    
+    /// The number of keyboard notifications received by the hub.
+    @objc public private(set) var notificationCount: Int = 0
+    
+    /// The number of keyboard events handled by dodgers. One notification is handled once by each dodger listening for it.
+    @objc public private(set) var eventCount: Int = 0
+    
+    /// The number of keyboard events dodgers sat out because their view was hidden or off screen.
+    @objc public private(set) var offScreenSkipCount: Int = 0
+    
+    /// The number of did events dodgers skipped because the will event before them had already updated along with the keyboard.
+    @objc public private(set) var decidedSkipCount: Int = 0
+    
+    /// The number of updates and resets skipped because the constraint was already where it needed to be.
+    @objc public private(set) var unchangedSkipCount: Int = 0
+    
+    /// The number of keyboard notifications dropped before reaching any dodger because a floating or split keyboard moved without docking or undocking.
+    @objc public private(set) var undockedSkipCount: Int = 0
+    
+    /// The number of animated layout passes.
+    @objc public private(set) var layoutCount: Int = 0
+    
+    /// The number of layout passes that fell into each of `layoutDurationBucketBounds`, plus one more bucket for anything slower.
+    @objc public private(set) var layoutDurationHistogram: [Int] = Array(repeating: 0, count: KeyboardDodgerInstrumentation.layoutDurationBucketBounds.count + 1)
+    
+    /// Sets every counter back to zero.
+    @objc public func resetCounters() {
+        notificationCount = 0
+        eventCount = 0
+        offScreenSkipCount = 0
+        decidedSkipCount = 0
+        unchangedSkipCount = 0
+        undockedSkipCount = 0
+        layoutCount = 0
+        layoutDurationHistogram = Array(repeating: 0, count: KeyboardDodgerInstrumentation.layoutDurationBucketBounds.count + 1)
+    }
+    
+    // MARK: Recording
+    
+    /// A counter incremented by the dodgers.
+    internal enum Counter {
+        case notification
+        case event
+        case offScreenSkip
+        case decidedSkip
+        case unchangedSkip
+        case undockedSkip
+    }
+    
+    internal func increment(_ counter: Counter, by count: Int = 1) {
+        guard isEnabled else {
+            return
+        }
+        
+        switch counter {
+        case .notification:
+            notificationCount += count
+        case .event:
+            eventCount += count
+        case .offScreenSkip:
+            offScreenSkipCount += count
+        case .decidedSkip:
+            decidedSkipCount += count
+        case .unchangedSkip:
+            unchangedSkipCount += count
+        case .undockedSkip:
+            undockedSkipCount += count
+        }
+    }
+    
+    /// Wraps the work in a signpost interval.
+    @discardableResult internal func interval<Result>(_ name: StaticString, _ work: () -> Result) -> Result {
+        guard isEnabled else {
+            return work()
+        }
+        
+        if #available(iOS 12.0, *) {
+            let signpostID = OSSignpostID(log: log)
+            os_signpost(.begin, log: log, name: name, signpostID: signpostID)
+            defer {
+                os_signpost(.end, log: log, name: name, signpostID: signpostID)
+            }
+            
+            return work()
+        }
+        
+        return work()
+    }
+    
+    /// Wraps a layout pass in a signpost interval, and records its duration in the histogram.
+    /// Returns the duration when enabled, or when `measuring` even if not, so a dodger can keep to its layout budget.
+    @discardableResult internal func layout(measuring: Bool = false, _ work: () -> Void) -> TimeInterval? {
+        guard isEnabled else {
+            guard measuring else {
+                work()
+                return nil
+            }
+            
+            let start = CACurrentMediaTime()
+            work()
+            return CACurrentMediaTime() - start
+        }
+        
+        let start = CACurrentMediaTime()
+        interval("Layout", work)
+        let duration = CACurrentMediaTime() - start
+        
+        let bucket = KeyboardDodgerInstrumentation.layoutDurationBucketBounds.firstIndex { duration < $0 } ?? KeyboardDodgerInstrumentation.layoutDurationBucketBounds.count
+        layoutDurationHistogram[bucket] += 1
+        layoutCount += 1
+        
+        return duration
+    }
+    
+    // MARK: Private helpers
+    
+    /// Logs to the Points of Interest category, which Instruments shows by default.
+    private let log = OSLog(subsystem: "com.trademe.KeyboardDodger", category: "PointsOfInterest")
+    
+}
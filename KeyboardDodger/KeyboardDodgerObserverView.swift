@@ -0,0 +1,53 @@
+//
+//  KeyboardDodgerObserverView.swift
+//  KeyboardDodger
+//
+//  Copyright (c) 2026 Trade Me. All rights reserved.
+//
+
+import UIKit
+
+// MARK: Keyboard dodger observer view
+
+/// An invisible, empty subview a keyboard dodger adds to its view, so it can hear about changes to the view's traits and size without subclassing it.
+internal final class KeyboardDodgerObserverView: UIView {
+    
+    /// The dodger to tell about changes.
+    weak var dodger: KeyboardDodger?
+    
+    init(dodger: KeyboardDodger) {
+        self.dodger = dodger
+        
+        super.init(frame: .zero)
+        
+        isHidden = true
+        autoresizingMask = [.flexibleWidth, .flexibleHeight]
+        isUserInteractionEnabled = false
+        isAccessibilityElement = false
+    }
+    
+    required init?(coder aDecoder: NSCoder) {
+        fatalError("init(coder:) has not been implemented")
+    }
+    
+    override func traitCollectionDidChange(_ previousTraitCollection: UITraitCollection?) {
+        super.traitCollectionDidChange(previousTraitCollection)
+        
+        dodger?.viewTraitsDidChange()
+    }
+    
+    override func layoutSubviews() {
+        super.layoutSubviews()
+        
+        // Sized to fill the view, so this is called whenever the view is resized
+        dodger?.viewLayoutDidChange()
+    }
+    
+    override func didMoveToWindow() {
+        super.didMoveToWindow()
+        
+        // The window's traits are part of the form sheet check too
+        dodger?.viewTraitsDidChange()
+    }
+    
+}
@@ -0,0 +1,42 @@
+//
+//  KeyboardDodgerOf.swift
+//  KeyboardDodger
+//
+//  Copyright (c) 2026 Trade Me. All rights reserved.
+//
+
+import UIKit
+
+// MARK: Keyboard dodger of
+
+/// A keyboard dodger for a single applier whose type is part of the dodger's own, for Swift code that wants the applier called without dynamic dispatch.
+///
+/// Appliers added with `add(_:)` are type-erased so they can share an array, and are called through the protocol. Here, the initializer is inlinable,
+/// so the apply step is specialized for the applier's type wherever the dodger is made, and `apply(overlap:)` is called directly, and can be inlined,
+/// from within the dodger's animation. Everything else, from the hub and the geometry to the strategy and the delegate, is shared with `dodger`.
+public final class KeyboardDodgerOf<Applier: KeyboardDodgerApplier> {
+    
+    /// The applier moved out of the way of the keyboard.
+    public let applier: Applier
+    
+    /// The dodger that listens for the keyboard and drives the applier, which has no constraint of its own.
+    /// Set its strategy, delegate and other options here, and add any other targets or appliers to move along with this one.
+    public let dodger: KeyboardDodger
+    
+    /// Instantiates a dodger that moves the applier out of the way of the keyboard overlapping the view.
+    /// Keep a reference to this around while you want it to.
+    @inlinable public convenience init(view: UIView, applier: Applier, delegate: KeyboardDodgerDelegate? = nil) {
+        let dodger = KeyboardDodger(view: view, targets: [], delegate: delegate)
+        
+        // Wrapped here, where the applier's type is known, so the wrapper calls it directly rather than through the protocol
+        dodger.specializedApplier = KeyboardDodger.AnyApplier(applier)
+        
+        self.init(applier: applier, dodger: dodger)
+    }
+    
+    @usableFromInline internal init(applier: Applier, dodger: KeyboardDodger) {
+        self.applier = applier
+        self.dodger = dodger
+    }
+    
+}
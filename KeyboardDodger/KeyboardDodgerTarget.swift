@@ -0,0 +1,121 @@
+//
+//  KeyboardDodgerTarget.swift
+//  KeyboardDodger
+//
+//  Copyright (c) 2026 Trade Me. All rights reserved.
+//
+
+import UIKit
+
+// MARK: Keyboard dodger target
+
+/// Something else a keyboard dodger moves out of the way of the keyboard, alongside its own constraint.
+/// From Swift, a `KeyboardDodgerApplier` does the same with no Objective-C message send.
+///
+/// All of a dodger's targets are applied within the same animation, followed by a single layout pass over their layout views.
+@objc public protocol KeyboardDodgerTarget: class {
+    
+    /// The view that needs laying out once the target has been applied, if any.
+    var layoutView: UIView? { get }
+    
+    /// Called inside the dodger's animation block to move the target out of the way of a keyboard overlapping the dodger's view
+    /// by `overlap` points. The overlap is zero when the keyboard is hidden, and the target should go back to where it started.
+    func keyboardDodger(_ keyboardDodger: KeyboardDodger, avoidOverlap overlap: CGFloat)
+    
+}
+
+// MARK: - Keyboard dodger constraint target
+
+/// The Objective-C counterpart to `KeyboardDodgerConstraintApplier`, which it forwards to.
+@objc public final class KeyboardDodgerConstraintTarget: NSObject, KeyboardDodgerTarget {
+    
+    /// The constraint to adjust, or `nil` once it has been deallocated.
+    @objc public var constraint: NSLayoutConstraint? {
+        return applier.constraint
+    }
+    
+    /// See the applier's `offset`.
+    @objc public var offset: CGFloat {
+        return applier.offset
+    }
+    
+    private let applier: KeyboardDodgerConstraintApplier
+    
+    @objc public init(constraint: NSLayoutConstraint, offset: CGFloat = 0.0) {
+        self.applier = KeyboardDodgerConstraintApplier(constraint: constraint, offset: offset)
+    }
+    
+    /// See the applier's `layoutView`.
+    @objc public var layoutView: UIView? {
+        return applier.layoutView
+    }
+    
+    @objc public func keyboardDodger(_ keyboardDodger: KeyboardDodger, avoidOverlap overlap: CGFloat) {
+        applier.apply(overlap: overlap)
+    }
+    
+}
+
+// MARK: - Keyboard dodger transform target
+
+/// The Objective-C counterpart to `KeyboardDodgerTransformApplier`, which it forwards to.
+@objc public final class KeyboardDodgerTransformTarget: NSObject, KeyboardDodgerTarget {
+    
+    /// The view to translate, or `nil` once it has been deallocated.
+    @objc public var view: UIView? {
+        return applier.view
+    }
+    
+    /// See the applier's `offset`.
+    @objc public var offset: CGFloat {
+        return applier.offset
+    }
+    
+    private let applier: KeyboardDodgerTransformApplier
+    
+    @objc public init(view: UIView, offset: CGFloat = 0.0) {
+        self.applier = KeyboardDodgerTransformApplier(view: view, offset: offset)
+    }
+    
+    /// See the applier's `layoutView`.
+    @objc public var layoutView: UIView? {
+        return applier.layoutView
+    }
+    
+    @objc public func keyboardDodger(_ keyboardDodger: KeyboardDodger, avoidOverlap overlap: CGFloat) {
+        applier.apply(overlap: overlap)
+    }
+    
+}
+
+// MARK: - Keyboard dodger scroll view target
+
+/// The Objective-C counterpart to `KeyboardDodgerScrollViewApplier`, which it forwards to.
+@objc public final class KeyboardDodgerScrollViewTarget: NSObject, KeyboardDodgerTarget {
+    
+    /// The scroll view to adjust, or `nil` once it has been deallocated.
+    @objc public var scrollView: UIScrollView? {
+        return applier.scrollView
+    }
+    
+    /// See the applier's `offset`.
+    @objc public var offset: CGFloat {
+        return applier.offset
+    }
+    
+    private let applier: KeyboardDodgerScrollViewApplier
+    
+    @objc public init(scrollView: UIScrollView, offset: CGFloat = 0.0) {
+        self.applier = KeyboardDodgerScrollViewApplier(scrollView: scrollView, offset: offset)
+    }
+    
+    /// See the applier's `layoutView`.
+    @objc public var layoutView: UIView? {
+        return applier.layoutView
+    }
+    
+    @objc public func keyboardDodger(_ keyboardDodger: KeyboardDodger, avoidOverlap overlap: CGFloat) {
+        applier.apply(overlap: overlap)
+    }
+    
+}
@@ -0,0 +1,185 @@
+//
+//  KeyboardDodgerTrace.swift
+//  KeyboardDodger
+//
+//  Copyright (c) 2026 Trade Me. All rights reserved.
+//
+
+import UIKit
+
+// Traces are a debugging aid, so they're left out of release builds unless an app asks for them, e.g. to record on devices in the field,
+// by adding KEYBOARD_DODGER_TRACES to the framework's active compilation conditions.
+#if DEBUG || KEYBOARD_DODGER_TRACES
+
+// MARK: Keyboard dodger trace
+
+/// A recorded sequence of keyboard notifications, which can be saved, and replayed later without a real keyboard.
+///
+/// Traces let storms of keyboard notifications seen on real devices (toggling a hardware keyboard, dictation, switching to emoji) be reproduced
+/// deterministically, e.g. to benchmark dodgers. Record one with a `KeyboardDodgerTraceRecorder`.
+public struct KeyboardDodgerTrace: Codable, Equatable {
+    
+    /// One recorded keyboard notification.
+    public struct Entry: Codable, Equatable {
+        
+        /// The notification's name, such as UIKeyboardWillChangeFrameNotification.
+        public var name: String
+        
+        /// When the notification was posted, in seconds since recording started.
+        public var time: TimeInterval
+        
+        /// The notification's userInfo.
+        public var payload: KeyboardDodgerPayload
+        
+        public init(name: Notification.Name, time: TimeInterval, payload: KeyboardDodgerPayload) {
+            self.name = name.rawValue
+            self.time = time
+            self.payload = payload
+        }
+        
+    }
+    
+    /// The size of the screen the trace was recorded on, which the keyboard frames are relative to.
+    public var screenSize: CGSize
+    
+    /// The recorded notifications, in the order they were posted.
+    public var entries: [Entry]
+    
+    public init(screenSize: CGSize, entries: [Entry] = []) {
+        self.screenSize = screenSize
+        self.entries = entries
+    }
+    
+    /// Loads a trace saved with `data()`.
+    public init(data: Data) throws {
+        self = try JSONDecoder().decode(KeyboardDodgerTrace.self, from: data)
+    }
+    
+    /// The trace encoded as JSON, for saving.
+    public func data() throws -> Data {
+        return try JSONEncoder().encode(self)
+    }
+    
+}
+
+// MARK: - Keyboard dodger trace recorder
+
+/// Records the keyboard notifications posted between `start()` and `stop()` into a trace.
+///
+/// A recorder is cheap to leave running in a debug build, e.g. started from a debug menu while reproducing a problem on a device.
+public final class KeyboardDodgerTraceRecorder {
+    
+    /// The keyboard notifications that are recorded.
+    public static let notificationNames: [Notification.Name] = [
+        UIResponder.keyboardWillShowNotification,
+        UIResponder.keyboardDidShowNotification,
+        UIResponder.keyboardWillHideNotification,
+        UIResponder.keyboardDidHideNotification,
+        UIResponder.keyboardWillChangeFrameNotification,
+        UIResponder.keyboardDidChangeFrameNotification
+    ]
+    
+    /// The notification center to record from.
+    public let notificationCenter: NotificationCenter
+    
+    public init(notificationCenter: NotificationCenter = .default) {
+        self.notificationCenter = notificationCenter
+    }
+    
+    deinit {
+        removeObservers()
+    }
+    
+    /// Whether the recorder is currently recording.
+    public var isRecording: Bool {
+        return observers.isEmpty == false
+    }
+    
+    /// Starts recording a new trace on the main screen, discarding anything recorded before.
+    public func start() {
+        removeObservers()
+        
+        trace = KeyboardDodgerTrace(screenSize: UIScreen.main.bounds.size)
+        startTime = CACurrentMediaTime()
+        
+        observers = KeyboardDodgerTraceRecorder.notificationNames.map { name in
+            notificationCenter.addObserver(forName: name, object: nil, queue: nil) { [weak self] notification in
+                self?.record(notification)
+            }
+        }
+    }
+    
+    /// Stops recording, and returns everything recorded since `start()`.
+    @discardableResult public func stop() -> KeyboardDodgerTrace {
+        removeObservers()
+        
+        return trace
+    }
+    
+    // MARK: Private helpers
+    
+    /// The trace recorded so far.
+    private var trace = KeyboardDodgerTrace(screenSize: .zero)
+    
+    /// When recording started, as a media time.
+    private var startTime: CFTimeInterval = 0.0
+    
+    private var observers: [NSObjectProtocol] = []
+    
+    private func record(_ notification: Notification) {
+        guard let userInfo = notification.userInfo, let payload = KeyboardDodgerPayload(dictionary: userInfo) else {
+            return
+        }
+        
+        trace.entries.append(KeyboardDodgerTrace.Entry(name: notification.name, time: CACurrentMediaTime() - startTime, payload: payload))
+    }
+    
+    private func removeObservers() {
+        for observer in observers {
+            notificationCenter.removeObserver(observer)
+        }
+        
+        observers = []
+    }
+    
+}
+
+// MARK: - Private helpers
+
+extension KeyboardDodgerPayload: Codable {
+    
+    private enum CodingKeys: String, CodingKey {
+        case startFrame
+        case endFrame
+        case animationDuration
+        case animationCurve
+    }
+    
+    public init(from decoder: Decoder) throws {
+        let container = try decoder.container(keyedBy: CodingKeys.self)
+        
+        // The keyboard uses a private curve, so the raw value isn't necessarily one of the named cases
+        let animationCurve = try container.decode(Int.self, forKey: .animationCurve)
+        
+        guard let curve = UIView.AnimationCurve(rawValue: animationCurve) else {
+            throw DecodingError.dataCorruptedError(forKey: .animationCurve, in: container, debugDescription: "Invalid animation curve \(animationCurve)")
+        }
+        
+        let startFrame = try container.decode(CGRect.self, forKey: .startFrame)
+        let endFrame = try container.decode(CGRect.self, forKey: .endFrame)
+        let animationDuration = try container.decode(TimeInterval.self, forKey: .animationDuration)
+        
+        self.init(startFrame: startFrame, endFrame: endFrame, animationDuration: animationDuration, animationCurve: curve)
+    }
+    
+    public func encode(to encoder: Encoder) throws {
+        var container = encoder.container(keyedBy: CodingKeys.self)
+        try container.encode(startFrame, forKey: .startFrame)
+        try container.encode(endFrame, forKey: .endFrame)
+        try container.encode(animationDuration, forKey: .animationDuration)
+        try container.encode(animationCurve.rawValue, forKey: .animationCurve)
+    }
+    
+}
+
+#endif
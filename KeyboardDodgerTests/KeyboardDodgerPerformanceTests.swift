@@ -0,0 +1,317 @@
+//
+//  KeyboardDodgerPerformanceTests.swift
+//  KeyboardDodgerTests
+//
+//  Copyright (c) 2026 Trade Me. All rights reserved.
+//
+
+import XCTest
+import KeyboardDodger
+
+// MARK: Keyboard dodger performance tests
+
+/// Benchmarks the work every dodger does for each keyboard notification, from parsing the payload through to updating and resetting constraints,
+/// for 1, 10 and 100 dodgers over a few representative view hierarchies, and for storms of notifications recorded on devices.
+class KeyboardDodgerPerformanceTests: XCTestCase {
+    
+    /// A view hierarchy for the dodgers' views to sit in.
+    private enum Hierarchy {
+        
+        /// Every dodger's view sits straight inside a full screen view controller's view.
+        case flat
+        
+        /// Every dodger's view sits at the bottom of a chain of nested views, so converting its frame walks the whole chain.
+        case deep
+        
+        /// Every dodger's view sits in a child view controller inset from the screen's edges like a form sheet, with a compact horizontal size class
+        /// in a regular window. The keyboard only partly overlaps it, and the dodgers wait for the keyboard to finish moving before they update.
+        case formSheet
+        
+    }
+    
+    /// How many views the deep hierarchy nests the dodgers' views inside.
+    private static let deepHierarchyDepth = 20
+    
+    private var window: UIWindow!
+    
+    /// The dodgers being benchmarked, kept alive for the length of the test.
+    private var dodgers: [KeyboardDodger] = []
+    
+    override func setUp() {
+        super.setUp()
+        
+        window = RegularWindow(frame: UIScreen.main.bounds)
+        window.rootViewController = UIViewController()
+        window.isHidden = false
+    }
+    
+    override func tearDown() {
+        dodgers = []
+        
+        window.isHidden = true
+        window = nil
+        
+        super.tearDown()
+    }
+    
+    // MARK: Flat hierarchy
+    
+    func testOneDodgerInFlatHierarchy() {
+        measureKeyboardChanges(dodgerCount: 1, hierarchy: .flat)
+    }
+    
+    func testTenDodgersInFlatHierarchy() {
+        measureKeyboardChanges(dodgerCount: 10, hierarchy: .flat)
+    }
+    
+    func testHundredDodgersInFlatHierarchy() {
+        measureKeyboardChanges(dodgerCount: 100, hierarchy: .flat)
+    }
+    
+    // MARK: Deep hierarchy
+    
+    func testOneDodgerInDeepHierarchy() {
+        measureKeyboardChanges(dodgerCount: 1, hierarchy: .deep)
+    }
+    
+    func testTenDodgersInDeepHierarchy() {
+        measureKeyboardChanges(dodgerCount: 10, hierarchy: .deep)
+    }
+    
+    func testHundredDodgersInDeepHierarchy() {
+        measureKeyboardChanges(dodgerCount: 100, hierarchy: .deep)
+    }
+    
+    // MARK: Form sheet hierarchy
+    
+    func testOneDodgerInFormSheetHierarchy() {
+        measureKeyboardChanges(dodgerCount: 1, hierarchy: .formSheet)
+    }
+    
+    func testTenDodgersInFormSheetHierarchy() {
+        measureKeyboardChanges(dodgerCount: 10, hierarchy: .formSheet)
+    }
+    
+    func testHundredDodgersInFormSheetHierarchy() {
+        measureKeyboardChanges(dodgerCount: 100, hierarchy: .formSheet)
+    }
+    
+    // MARK: Recorded traces
+    
+    func testTenDodgersReplayingEmojiSwitchTrace() throws {
+        try measureReplay(of: "EmojiSwitchTrace", dodgerCount: 10)
+    }
+    
+    func testHundredDodgersReplayingEmojiSwitchTrace() throws {
+        try measureReplay(of: "EmojiSwitchTrace", dodgerCount: 100)
+    }
+    
+    // MARK: Private helpers
+    
+    /// How long the synthesized keyboard animations take, in seconds.
+    private static let animationDuration: TimeInterval = 0.25
+    
+    /// The will notifications the hub handles, keyed by the did notifications they decide for.
+    private static let decidingNotificationNames: [Notification.Name: Notification.Name] = [
+        UIResponder.keyboardDidChangeFrameNotification: UIResponder.keyboardWillChangeFrameNotification,
+        UIResponder.keyboardDidHideNotification: UIResponder.keyboardWillHideNotification
+    ]
+    
+    /// Measures a trace checked in to the test bundle being replayed over `dodgerCount` dodgers in the flat hierarchy, as fast as it can be posted.
+    ///
+    /// The trace is fitted to the screen the tests run on, so the keyboard stays docked whichever device recorded it.
+    private func measureReplay(of resource: String, dodgerCount: Int, file: StaticString = #file, line: UInt = #line) throws {
+        let trace = try KeyboardDodgerTrace(resource: resource, in: Bundle(for: KeyboardDodgerPerformanceTests.self)).fitted(to: UIScreen.main.bounds)
+        
+        makeDodgers(count: dodgerCount, in: .flat)
+        
+        // Work out what the hub should see. Every will notification decides for its did notification, and the next did notification uses the
+        // decision up, even if a later will notification has replaced it since.
+        var notificationCount = 0
+        var decidedSkipCount = 0
+        var decidingNames = Set<Notification.Name>()
+        
+        for entry in trace.entries {
+            let name = Notification.Name(rawValue: entry.name)
+            
+            if let decidingName = KeyboardDodgerPerformanceTests.decidingNotificationNames[name] {
+                notificationCount += 1
+                
+                if decidingNames.remove(decidingName) != nil {
+                    decidedSkipCount += 1
+                }
+            } else if KeyboardDodgerPerformanceTests.decidingNotificationNames.values.contains(name) {
+                notificationCount += 1
+                decidingNames.insert(name)
+            }
+        }
+        
+        // Check every dodger sees the whole storm first, so the numbers aren't only measuring skips
+        let instrumentation = KeyboardDodgerInstrumentation.shared
+        instrumentation.resetCounters()
+        instrumentation.isEnabled = true
+        trace.replay()
+        instrumentation.isEnabled = false
+        waitForAnimations()
+        
+        XCTAssertEqual(instrumentation.notificationCount, notificationCount, file: file, line: line)
+        XCTAssertEqual(instrumentation.decidedSkipCount, dodgerCount * decidedSkipCount, file: file, line: line)
+        XCTAssertEqual(instrumentation.eventCount, dodgerCount * (notificationCount - decidedSkipCount), file: file, line: line)
+        XCTAssertEqual(instrumentation.offScreenSkipCount, 0, file: file, line: line)
+        XCTAssertEqual(instrumentation.undockedSkipCount, 0, file: file, line: line)
+        XCTAssertGreaterThan(instrumentation.layoutCount, 0, file: file, line: line)
+        
+        let options = XCTMeasureOptions()
+        options.invocationOptions = [.manuallyStop]
+        
+        measure(metrics: [XCTClockMetric(), XCTCPUMetric(), XCTMemoryMetric()], options: options) {
+            trace.replay()
+            stopMeasuring()
+            
+            waitForAnimations()
+        }
+    }
+    
+    /// Measures the keyboard being shown and hidden again over `dodgerCount` dodgers in the hierarchy, with synthesized notifications.
+    ///
+    /// The keyboard is shown with a will and did change frame, and hidden with a will and did hide, so both the update and reset paths run,
+    /// along with the did events' path through the hub. Each iteration waits for the dodgers' animations to finish outside of the measurement,
+    /// so every iteration starts from the same state.
+    private func measureKeyboardChanges(dodgerCount: Int, hierarchy: Hierarchy, file: StaticString = #file, line: UInt = #line) {
+        makeDodgers(count: dodgerCount, in: hierarchy)
+        
+        let screenBounds = UIScreen.main.bounds
+        let hiddenFrame = CGRect(x: 0.0, y: screenBounds.maxY, width: screenBounds.width, height: 300.0)
+        let shownFrame = hiddenFrame.offsetBy(dx: 0.0, dy: -hiddenFrame.height)
+        
+        // The keyboard's own private curve, as sent by the system
+        let animationCurve = UIView.AnimationCurve(rawValue: 7)!
+        let show = KeyboardDodgerPayload(startFrame: hiddenFrame, endFrame: shownFrame, animationDuration: KeyboardDodgerPerformanceTests.animationDuration, animationCurve: animationCurve)
+        let hide = KeyboardDodgerPayload(startFrame: shownFrame, endFrame: hiddenFrame, animationDuration: KeyboardDodgerPerformanceTests.animationDuration, animationCurve: animationCurve)
+        
+        let showAndHide = {
+            self.post(UIResponder.keyboardWillChangeFrameNotification, with: show)
+            self.post(UIResponder.keyboardDidChangeFrameNotification, with: show)
+            self.post(UIResponder.keyboardWillHideNotification, with: hide)
+            self.post(UIResponder.keyboardDidHideNotification, with: hide)
+        }
+        
+        // Check every dodger handles the notifications first, so the numbers aren't only measuring skips
+        let instrumentation = KeyboardDodgerInstrumentation.shared
+        instrumentation.resetCounters()
+        instrumentation.isEnabled = true
+        showAndHide()
+        instrumentation.isEnabled = false
+        waitForAnimations()
+        
+        // A form sheet waits for the keyboard to finish showing before updating, so it handles the did change frame too.
+        // Every other did event is skipped by the hub, as its will event has already done the work.
+        let handledCount = hierarchy == .formSheet ? 3 : 2
+        
+        XCTAssertEqual(instrumentation.eventCount, dodgerCount * handledCount, file: file, line: line)
+        XCTAssertEqual(instrumentation.decidedSkipCount, dodgerCount * (4 - handledCount), file: file, line: line)
+        XCTAssertEqual(instrumentation.offScreenSkipCount, 0, file: file, line: line)
+        XCTAssertEqual(instrumentation.undockedSkipCount, 0, file: file, line: line)
+        
+        // One layout pass to update, and one to reset
+        XCTAssertEqual(instrumentation.layoutCount, dodgerCount * 2, file: file, line: line)
+        
+        let options = XCTMeasureOptions()
+        options.invocationOptions = [.manuallyStop]
+        
+        measure(metrics: [XCTClockMetric(), XCTCPUMetric(), XCTMemoryMetric()], options: options) {
+            showAndHide()
+            stopMeasuring()
+            
+            waitForAnimations()
+        }
+    }
+    
+    private func post(_ name: Notification.Name, with payload: KeyboardDodgerPayload) {
+        NotificationCenter.default.post(name: name, object: nil, userInfo: payload.dictionary)
+    }
+    
+    /// Turns the run loop until the dodgers' animations have finished, so their animators don't pile up moves from one iteration to the next.
+    private func waitForAnimations() {
+        RunLoop.current.run(until: Date(timeIntervalSinceNow: KeyboardDodgerPerformanceTests.animationDuration + 0.1))
+    }
+    
+    /// Builds the hierarchy in the window, and fills it with dodgers.
+    private func makeDodgers(count: Int, in hierarchy: Hierarchy) {
+        let container = makeContainer(for: hierarchy)
+        dodgers = (0..<count).map { _ in makeDodger(in: container) }
+        window.layoutIfNeeded()
+    }
+    
+    /// Builds the hierarchy in the window, and returns the view the dodgers' views should be added to.
+    ///
+    /// The hierarchy sits in a child view controller whose size class is set explicitly, so the form sheet check gives the same answer on any device.
+    private func makeContainer(for hierarchy: Hierarchy) -> UIView {
+        let rootViewController = window.rootViewController!
+        let rootView: UIView = rootViewController.view
+        rootView.frame = window.bounds
+        
+        let contentController = UIViewController()
+        rootViewController.addChild(contentController)
+        
+        let bounds = rootView.bounds
+        contentController.view.frame = hierarchy == .formSheet ? bounds.insetBy(dx: bounds.width * 0.1, dy: bounds.height * 0.15) : bounds
+        contentController.view.autoresizingMask = [.flexibleWidth, .flexibleHeight]
+        rootView.addSubview(contentController.view)
+        contentController.didMove(toParent: rootViewController)
+        
+        // A form sheet is compact inside a regular window, which is what the dodgers check for. Anything else fills the window's size class.
+        let horizontalSizeClass: UIUserInterfaceSizeClass = hierarchy == .formSheet ? .compact : .regular
+        rootViewController.setOverrideTraitCollection(UITraitCollection(horizontalSizeClass: horizontalSizeClass), forChild: contentController)
+        
+        let contentView: UIView = contentController.view
+        
+        switch hierarchy {
+        case .flat, .formSheet:
+            return contentView
+        case .deep:
+            return (0..<KeyboardDodgerPerformanceTests.deepHierarchyDepth).reduce(contentView) { superview, _ in
+                makeView(in: superview, frame: superview.bounds)
+            }
+        }
+    }
+    
+    /// Adds a view filling the superview, with a content view pinned inside it by a bottom constraint for the dodger to move.
+    private func makeDodger(in superview: UIView) -> KeyboardDodger {
+        let view = makeView(in: superview, frame: superview.bounds)
+        
+        let contentView = UIView()
+        contentView.translatesAutoresizingMaskIntoConstraints = false
+        view.addSubview(contentView)
+        
+        let bottomConstraint = view.bottomAnchor.constraint(equalTo: contentView.bottomAnchor)
+        
+        NSLayoutConstraint.activate([
+            contentView.topAnchor.constraint(equalTo: view.topAnchor),
+            contentView.leadingAnchor.constraint(equalTo: view.leadingAnchor),
+            contentView.trailingAnchor.constraint(equalTo: view.trailingAnchor),
+            bottomConstraint
+        ])
+        
+        return KeyboardDodger(view: view, constraint: bottomConstraint)
+    }
+    
+    private func makeView(in superview: UIView, frame: CGRect) -> UIView {
+        let view = UIView(frame: frame)
+        view.autoresizingMask = [.flexibleWidth, .flexibleHeight]
+        superview.addSubview(view)
+        return view
+    }
+    
+}
+
+// MARK: - Regular window
+
+/// A window with a regular horizontal size class, like an iPad's full screen window, whichever device the tests run on.
+private final class RegularWindow: UIWindow {
+    
+    override var traitCollection: UITraitCollection {
+        return UITraitCollection(traitsFrom: [super.traitCollection, UITraitCollection(horizontalSizeClass: .regular)])
+    }
+    
+}
@@ -0,0 +1,84 @@
+//
+//  KeyboardDodgerTraceReplay.swift
+//  KeyboardDodgerTests
+//
+//  Copyright (c) 2026 Trade Me. All rights reserved.
+//
+
+import UIKit
+import KeyboardDodger
+
+// MARK: Keyboard dodger trace replay
+
+extension KeyboardDodgerTrace {
+    
+    /// Loads a trace checked in to the test bundle as a JSON resource.
+    init(resource: String, in bundle: Bundle) throws {
+        guard let url = bundle.url(forResource: resource, withExtension: "json") else {
+            throw CocoaError(.fileNoSuchFile)
+        }
+        
+        try self.init(data: try Data(contentsOf: url))
+    }
+    
+    /// The trace, as if it had been recorded on a screen with the given bounds.
+    ///
+    /// The keyboard is docked to the bottom of the screen, so each frame keeps its distance from the bottom edge, and any frame that spanned the
+    /// recorded screen's width spans the new one.
+    func fitted(to screenBounds: CGRect) -> KeyboardDodgerTrace {
+        let fit = { (frame: CGRect) -> CGRect in
+            var frame = frame
+            frame.origin.y += screenBounds.maxY - self.screenSize.height
+            
+            if frame.minX == 0.0 && frame.width == self.screenSize.width {
+                frame.origin.x = screenBounds.minX
+                frame.size.width = screenBounds.width
+            }
+            
+            return frame
+        }
+        
+        let fittedEntries = entries.map { entry -> Entry in
+            var entry = entry
+            entry.payload.startFrame = fit(entry.payload.startFrame)
+            entry.payload.endFrame = fit(entry.payload.endFrame)
+            return entry
+        }
+        
+        return KeyboardDodgerTrace(screenSize: screenBounds.size, entries: fittedEntries)
+    }
+    
+    /// Posts every notification in the trace straight away, one after the other.
+    func replay(notificationCenter: NotificationCenter = .default) {
+        for entry in entries {
+            entry.post(to: notificationCenter)
+        }
+    }
+    
+    /// Posts each notification in the trace on the main queue, at the same time after replay starts as it was recorded after recording started,
+    /// and then calls the completion handler.
+    func replayInRealTime(notificationCenter: NotificationCenter = .default, completion: (() -> Void)? = nil) {
+        let start = DispatchTime.now()
+        
+        for entry in entries {
+            DispatchQueue.main.asyncAfter(deadline: start + entry.time) {
+                entry.post(to: notificationCenter)
+            }
+        }
+        
+        DispatchQueue.main.asyncAfter(deadline: start + (entries.last?.time ?? 0.0)) {
+            completion?()
+        }
+    }
+    
+}
+
+// MARK: - Private helpers
+
+extension KeyboardDodgerTrace.Entry {
+    
+    fileprivate func post(to notificationCenter: NotificationCenter) {
+        notificationCenter.post(name: Notification.Name(rawValue: name), object: nil, userInfo: payload.dictionary)
+    }
+    
+}